@@ -1,4 +1,5 @@
 #include "AGameObject.h"
+#include "GameObjectManager.h"
 
 AGameObject::AGameObject(String name)
 {
@@ -15,6 +16,9 @@ AGameObject::String AGameObject::getName() {
 }
 
 void AGameObject::draw(sf::RenderWindow* targetWindow) {
+	//the sprite still points at a texture that was unloaded
+	if (this->textureHandle.isExpired()) return;
+
 	if (this->sprite != NULL) {
 		this->sprite->setPosition(this->posX, this->posY);
 		this->sprite->setScale(this->scaleX, this->scaleY);
@@ -27,6 +31,10 @@ void AGameObject::setPosition(float x, float y)
 	this->posX = x;
 	this->posY = y;
 
+	if (this->entityID != EntityStore::INVALID_ENTITY) {
+		GameObjectManager::getInstance()->getEntityStore()->setPosition(this->entityID, x, y);
+	}
+
 	if(this->sprite != nullptr)
 	{
 		this->sprite->setPosition(this->posX, this->posY);
@@ -38,6 +46,10 @@ void AGameObject::setScale(float x, float y)
 	this->scaleX = x;
 	this->scaleY = y;
 
+	if (this->entityID != EntityStore::INVALID_ENTITY) {
+		GameObjectManager::getInstance()->getEntityStore()->setScale(this->entityID, x, y);
+	}
+
 	if (this->sprite != nullptr)
 	{
 		this->sprite->setScale(this->scaleX, this->scaleY);
@@ -46,15 +58,44 @@ void AGameObject::setScale(float x, float y)
 
 sf::Vector2f AGameObject::getPosition()
 {
-	return this->sprite->getPosition();
+	return sf::Vector2f(this->posX, this->posY);
 }
 
 sf::Vector2f AGameObject::getScale()
 {
-	return this->sprite->getScale();
+	return sf::Vector2f(this->scaleX, this->scaleY);
 }
 
 sf::FloatRect AGameObject::getLocalBounds()
 {
+	if (this->entityID != EntityStore::INVALID_ENTITY) {
+		sf::IntRect rect = GameObjectManager::getInstance()->getEntityStore()->getTextureRect(this->entityID);
+		return sf::FloatRect(0.0f, 0.0f, static_cast<float>(rect.width), static_cast<float>(rect.height));
+	}
+	if (this->sprite == nullptr) return sf::FloatRect();
 	return this->sprite->getLocalBounds();
 }
+
+bool AGameObject::runsBehaviour() const
+{
+	return this->hasBehaviour;
+}
+
+EntityStore::EntityID AGameObject::getEntityID() const
+{
+	return this->entityID;
+}
+
+ObjectHandle AGameObject::getHandle() const
+{
+	return this->handle;
+}
+
+void AGameObject::makeEntity(const TextureHandle& texture, const sf::IntRect& textureRect, bool isStatic)
+{
+	EntityStore* store = GameObjectManager::getInstance()->getEntityStore();
+	this->entityID = store->create(texture, textureRect);
+	store->setPosition(this->entityID, this->posX, this->posY);
+	store->setScale(this->entityID, this->scaleX, this->scaleY);
+	store->setStatic(this->entityID, isStatic);
+}
@@ -1,13 +1,16 @@
 #pragma once
 #include <SFML/Graphics.hpp>
 #include <string>
+#include "TextureHandle.h"
+#include "EntityStore.h"
+#include "ObjectHandle.h"
 
 class AGameObject: sf::NonCopyable
 {
 	public:
 		typedef std::string String;
 		AGameObject(String name);
-		~AGameObject();
+		virtual ~AGameObject();
 		virtual void initialize() = 0;
 		virtual void processInput(sf::Event event) = 0;
 		virtual void update(sf::Time deltaTime) = 0;
@@ -20,12 +23,28 @@ class AGameObject: sf::NonCopyable
 		virtual sf::Vector2f getPosition();
 		virtual sf::Vector2f getScale();
 
+		bool runsBehaviour() const; //false when processInput and update do nothing, the manager then skips them
+		EntityStore::EntityID getEntityID() const;
+		ObjectHandle getHandle() const; //issued by GameObjectManager::addObject
+
 	protected:
+		//turns the object into a plain textured quad in GameObjectManager's EntityStore, drawn by the manager
+		//without a sprite of its own. call from initialize, the current position and scale carry over.
+		//static entities are for objects that never move, their geometry stays on the GPU between frames
+		void makeEntity(const TextureHandle& texture, const sf::IntRect& textureRect, bool isStatic = false);
+
 		String name;
-		sf::Sprite* sprite = new sf::Sprite();
-		sf::Texture* texture = new sf::Texture();
+		sf::Sprite* sprite = nullptr; //allocated by the objects that draw one
+		sf::Texture* texture = nullptr;
+		TextureHandle textureHandle; //keeps the sprite's texture resident, see TextureManager
+		bool hasBehaviour = true;
+		EntityStore::EntityID entityID = EntityStore::INVALID_ENTITY;
 
 		float posX = 0.0f; float posY = 0.0f;
 		float scaleX = 1.0f; float scaleY = 1.0f;
+
+	private:
+		friend class GameObjectManager;
+		ObjectHandle handle;
 };
 
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <mutex>
+
+/// <summary>
+/// Grow-only list that readers can index without taking a lock. Elements live in segments that double in size
+/// and are never moved or freed while the list is alive, so a pointer read by one thread stays valid while
+/// another thread appends. Writers are serialized by a mutex and publish an element by bumping the count
+/// after it was stored; a reader that sees Size() > i can read element i.
+/// </summary>
+template <typename T>
+class AppendOnlyList {
+public:
+	AppendOnlyList() {
+		for (auto& segment : this->segments) {
+			segment.store(nullptr, std::memory_order_relaxed);
+		}
+	}
+
+	~AppendOnlyList() {
+		for (auto& segment : this->segments) {
+			delete[] segment.load(std::memory_order_relaxed);
+		}
+	}
+
+	AppendOnlyList(const AppendOnlyList&) = delete;
+	AppendOnlyList& operator=(const AppendOnlyList&) = delete;
+
+	//returns the index the value was stored at
+	size_t PushBack(const T& _value) {
+		std::lock_guard<std::mutex> lock(this->writeMutex);
+
+		size_t index = this->count.load(std::memory_order_relaxed);
+		size_t segment, offset;
+		Locate(index, segment, offset);
+
+		T* cells = this->segments[segment].load(std::memory_order_relaxed);
+		if (cells == nullptr) {
+			cells = new T[FIRST_SEGMENT_SIZE << segment]();
+			this->segments[segment].store(cells, std::memory_order_release);
+		}
+		cells[offset] = _value;
+
+		this->count.store(index + 1, std::memory_order_release);
+		return index;
+	}
+
+	//only valid for _index < Size()
+	T Get(size_t _index) const {
+		size_t segment, offset;
+		Locate(_index, segment, offset);
+		return this->segments[segment].load(std::memory_order_acquire)[offset];
+	}
+
+	size_t Size() const {
+		return this->count.load(std::memory_order_acquire);
+	}
+
+private:
+	static const size_t FIRST_SEGMENT_SIZE = 64;
+	static const size_t SEGMENT_COUNT = 32; //64 * (2^32 - 1) elements, never the limit in practice
+
+	//segment s holds indices [64 * (2^s - 1), 64 * (2^(s+1) - 1))
+	static void Locate(size_t _index, size_t& _segment, size_t& _offset) {
+		size_t block = _index / FIRST_SEGMENT_SIZE + 1;
+		_segment = std::bit_width(block) - 1;
+		_offset = _index - FIRST_SEGMENT_SIZE * ((size_t(1) << _segment) - 1);
+	}
+
+	std::atomic<T*> segments[SEGMENT_COUNT];
+	std::atomic<size_t> count = 0;
+	std::mutex writeMutex;
+};
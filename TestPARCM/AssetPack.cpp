@@ -0,0 +1,354 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include "AssetPack.h"
+#include "DecodedImageCache.h"
+#include "MathUtils.h"
+
+namespace {
+	const char PACK_MAGIC[4] = { 'A', 'P', 'A', 'K' };
+
+	struct PackHeader {
+		char magic[4];
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t directoryCount;
+		uint32_t tocSize;
+	};
+
+	template <typename T>
+	bool readValue(const char*& cursor, const char* end, T& value) {
+		if (static_cast<size_t>(end - cursor) < sizeof(T)) return false;
+		std::memcpy(&value, cursor, sizeof(T));
+		cursor += sizeof(T);
+		return true;
+	}
+
+	template <typename T>
+	void writeValue(std::ostream& stream, T value) {
+		stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	int64_t modifiedTicks(const std::string& path, std::error_code& error) {
+		return static_cast<int64_t>(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+	}
+}
+
+void AssetBytes::clear()
+{
+	this->data = nullptr;
+	this->size = 0;
+	this->ownedBytes.clear();
+	this->ownedBytes.shrink_to_fit();
+}
+
+//a singleton class. created eagerly, loader threads look assets up from the start.
+AssetPack* AssetPack::sharedInstance = new AssetPack();
+
+AssetPack* AssetPack::getInstance() {
+	return sharedInstance;
+}
+
+bool AssetPack::openOrBuild(const String& packPath, const String& sourceDirectory, bool forceRebuild)
+{
+	if (this->open(packPath)) {
+		if (!forceRebuild && this->isCurrent()) return true;
+
+		//the mapping has to go before the rebuilt pack can replace the file
+		std::cout << "[AssetPack] " << packPath << (forceRebuild ? " rebuild requested" : " is out of date") << std::endl;
+		this->entries.clear();
+		this->mapping.close();
+	}
+
+	std::cout << "[AssetPack] Building " << packPath << " from " << sourceDirectory << std::endl;
+	if (!build(packPath, sourceDirectory)) return false;
+	return this->open(packPath);
+}
+
+bool AssetPack::build(const String& packPath, const String& sourceDirectory)
+{
+	std::error_code error;
+	std::vector<String> paths;
+	std::vector<String> directories;
+	if (!collectSources(sourceDirectory, paths, directories)) return false;
+
+	//the table of contents has to be sized up front so blob offsets can be written into it
+	uint64_t tocSize = 0;
+	std::vector<uint64_t> sizes;
+	for (const String& path : paths) {
+		tocSize += sizeof(uint64_t) * 2 + sizeof(uint32_t) + path.size();
+		sizes.push_back(std::filesystem::file_size(path, error));
+		if (error) return false;
+	}
+	for (const String& directory : directories) {
+		tocSize += sizeof(int64_t) + sizeof(uint32_t) + directory.size();
+	}
+
+	std::vector<uint64_t> offsets;
+	uint64_t offset = sizeof(PackHeader) + tocSize;
+	for (uint64_t size : sizes) {
+		offset = (offset + BLOB_ALIGNMENT - 1) / BLOB_ALIGNMENT * BLOB_ALIGNMENT;
+		offsets.push_back(offset);
+		offset += size;
+	}
+
+	//write next to the target and rename at the end, a crash halfway never leaves a truncated pack behind
+	String tempPath = packPath + ".tmp";
+	std::vector<uint64_t> timePositions;
+	{
+		std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+		if (!stream) return false;
+
+		PackHeader header;
+		std::memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+		header.version = PACK_VERSION;
+		header.entryCount = static_cast<uint32_t>(paths.size());
+		header.directoryCount = static_cast<uint32_t>(directories.size());
+		header.tocSize = static_cast<uint32_t>(tocSize);
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		for (size_t i = 0; i < paths.size(); i++) {
+			writeValue<uint64_t>(stream, offsets[i]);
+			writeValue<uint64_t>(stream, sizes[i]);
+			writeValue<uint32_t>(stream, static_cast<uint32_t>(paths[i].size()));
+			stream.write(paths[i].data(), paths[i].size());
+		}
+		for (size_t i = 0; i < directories.size(); i++) {
+			timePositions.push_back(static_cast<uint64_t>(stream.tellp()));
+			writeValue<int64_t>(stream, 0); //filled in once the pack is in place
+			writeValue<uint32_t>(stream, static_cast<uint32_t>(directories[i].size()));
+			stream.write(directories[i].data(), directories[i].size());
+		}
+
+		std::vector<char> bytes;
+		for (size_t i = 0; i < paths.size(); i++) {
+			uint64_t position = static_cast<uint64_t>(stream.tellp());
+			bytes.assign(offsets[i] - position, 0);
+			stream.write(bytes.data(), bytes.size());
+
+			std::ifstream source(paths[i], std::ios::binary);
+			bytes.resize(sizes[i]);
+			if (!source.read(bytes.data(), bytes.size())) return false;
+			stream.write(bytes.data(), bytes.size());
+		}
+
+		if (!stream) return false;
+	}
+
+	std::filesystem::rename(tempPath, packPath, error);
+	if (error) {
+		std::cout << "[AssetPack] Could not write " << packPath << ": " << error.message() << std::endl;
+		return false;
+	}
+
+	//creating and renaming the pack touched its own folder, so the folder times are taken only now. rewriting
+	//bytes of an existing file leaves the folder alone
+	{
+		std::fstream stream(packPath, std::ios::binary | std::ios::in | std::ios::out);
+		for (size_t i = 0; i < directories.size(); i++) {
+			int64_t modifiedTime = modifiedTicks(directories[i], error);
+			if (error) return false;
+			stream.seekp(static_cast<std::streamoff>(timePositions[i]));
+			writeValue<int64_t>(stream, modifiedTime);
+		}
+		if (!stream) return false;
+	}
+
+	std::cout << "[AssetPack] Packed " << paths.size() << " files" << std::endl;
+	return true;
+}
+
+bool AssetPack::open(const String& packPath)
+{
+	this->entries.clear();
+	this->directories.clear();
+	if (!this->mapping.open(packPath)) return false;
+
+	const char* cursor = this->mapping.getData();
+	const char* end = cursor + this->mapping.getSize();
+
+	PackHeader header;
+	if (!readValue(cursor, end, header) || std::memcmp(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 ||
+		header.version != PACK_VERSION) {
+		std::cout << "[AssetPack] " << packPath << " is not a valid pack" << std::endl;
+		this->mapping.close();
+		return false;
+	}
+
+	for (uint32_t i = 0; i < header.entryCount; i++) {
+		Entry entry;
+		uint32_t pathLength = 0;
+		if (!readValue(cursor, end, entry.offset) || !readValue(cursor, end, entry.size) ||
+			!readValue(cursor, end, pathLength) || static_cast<size_t>(end - cursor) < pathLength ||
+			entry.offset + entry.size > this->mapping.getSize()) {
+			std::cout << "[AssetPack] " << packPath << " is truncated" << std::endl;
+			this->entries.clear();
+			this->mapping.close();
+			return false;
+		}
+
+		this->entries[String(cursor, pathLength)] = entry;
+		cursor += pathLength;
+	}
+
+	for (uint32_t i = 0; i < header.directoryCount; i++) {
+		SourceDirectory directory;
+		uint32_t pathLength = 0;
+		if (!readValue(cursor, end, directory.modifiedTime) || !readValue(cursor, end, pathLength) ||
+			static_cast<size_t>(end - cursor) < pathLength) {
+			std::cout << "[AssetPack] " << packPath << " is truncated" << std::endl;
+			this->entries.clear();
+			this->directories.clear();
+			this->mapping.close();
+			return false;
+		}
+
+		directory.path.assign(cursor, pathLength);
+		this->directories.push_back(directory);
+		cursor += pathLength;
+	}
+
+	std::cout << "[AssetPack] Opened " << packPath << " with " << this->entries.size() << " files" << std::endl;
+	return true;
+}
+
+bool AssetPack::isCurrent() const
+{
+	//adding, removing or renaming a file touches its folder, so one stat per folder replaces walking every file
+	if (this->directories.empty()) return false;
+	for (const SourceDirectory& directory : this->directories) {
+		std::error_code error;
+		int64_t modifiedTime = modifiedTicks(directory.path, error);
+		if (error || modifiedTime != directory.modifiedTime) return false;
+	}
+	return true;
+}
+
+bool AssetPack::find(const String& path, const char*& data, size_t& size) const
+{
+	if (this->entries.empty()) return false;
+
+	auto found = this->entries.find(normalizePath(path));
+	if (found == this->entries.end()) return false;
+
+	data = this->mapping.getData() + found->second.offset;
+	size = static_cast<size_t>(found->second.size);
+	return true;
+}
+
+bool AssetPack::read(const String& path, AssetBytes& bytes) const
+{
+	if (this->find(path, bytes.data, bytes.size)) return true;
+
+	std::ifstream stream(path, std::ios::binary | std::ios::ate);
+	if (!stream) return false;
+
+	std::streamsize size = stream.tellg();
+	stream.seekg(0, std::ios::beg);
+	bytes.ownedBytes.resize(static_cast<size_t>(size));
+	if (!stream.read(bytes.ownedBytes.data(), size)) return false;
+
+	bytes.data = bytes.ownedBytes.data();
+	bytes.size = bytes.ownedBytes.size();
+	return true;
+}
+
+int AssetPack::getCount() const
+{
+	return this->entries.size();
+}
+
+bool AssetPack::loadTexture(sf::Texture& texture, const String& path, const sf::Vector2u& maxSize) const
+{
+	sf::Image image;
+	if (!this->loadImage(image, path, maxSize)) return false;
+	return texture.loadFromImage(image);
+}
+
+bool AssetPack::loadImage(sf::Image& image, const String& path, const sf::Vector2u& maxSize) const
+{
+	AssetBytes bytes;
+	if (!this->read(path, bytes)) return false;
+	//the decoded cache keeps the full size image, so one cached decode serves every display size
+	if (!DecodedImageCache::getInstance()->decode(path, bytes, image)) return false;
+	shrinkToFit(image, maxSize);
+	return true;
+}
+
+bool AssetPack::loadFont(sf::Font& font, const String& path) const
+{
+	const char* data; size_t size;
+	if (this->find(path, data, size)) return font.loadFromMemory(data, size);
+	return font.loadFromFile(path);
+}
+
+bool AssetPack::shrinkToFit(sf::Image& image, const sf::Vector2u& maxSize)
+{
+	sf::Vector2u size = image.getSize();
+	if (size.x == 0 || size.y == 0) return false;
+
+	float scale = 1.0f;
+	if (maxSize.x > 0) scale = std::min(scale, static_cast<float>(maxSize.x) / size.x);
+	if (maxSize.y > 0) scale = std::min(scale, static_cast<float>(maxSize.y) / size.y);
+	if (scale >= 1.0f) return false;
+
+	unsigned int width = std::max(1u, static_cast<unsigned int>(std::lround(size.x * scale)));
+	unsigned int height = std::max(1u, static_cast<unsigned int>(std::lround(size.y * scale)));
+	if (width >= size.x && height >= size.y) return false;
+
+	std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+	MathUtils::resampleRGBA(image.getPixelsPtr(), size.x, size.y, pixels.data(), width, height, MathUtils::FILTER_BOX);
+	image.create(width, height, pixels.data());
+	return true;
+}
+
+float AssetPack::shrinkToScale(sf::Image& image, float displayScale)
+{
+	sf::Vector2u size = image.getSize();
+	if (displayScale >= 1.0f || size.x == 0 || size.y == 0) return displayScale;
+
+	sf::Vector2u target(
+		static_cast<unsigned int>(std::ceil(size.x * displayScale)),
+		static_cast<unsigned int>(std::ceil(size.y * displayScale)));
+	if (!shrinkToFit(image, target)) return displayScale;
+
+	//whatever rounding is left over, so the sprite ends up exactly as large on screen as before
+	return displayScale * static_cast<float>(size.x) / image.getSize().x;
+}
+
+bool AssetPack::collectSources(const String& sourceDirectory, std::vector<String>& paths, std::vector<String>& directories)
+{
+	std::error_code error;
+	directories.push_back(normalizePath(sourceDirectory));
+	for (const auto& file : std::filesystem::recursive_directory_iterator(sourceDirectory, error)) {
+		if (file.is_directory()) directories.push_back(normalizePath(file.path().generic_string()));
+		if (!file.is_regular_file()) continue;
+
+		String path = file.path().generic_string();
+		if (isPackable(path)) paths.push_back(normalizePath(path));
+	}
+	if (error) {
+		std::cout << "[AssetPack] Failed to scan " << sourceDirectory << ": " << error.message() << std::endl;
+		return false;
+	}
+	std::sort(paths.begin(), paths.end());
+	std::sort(directories.begin(), directories.end());
+	return true;
+}
+
+AssetPack::String AssetPack::normalizePath(const String& path)
+{
+	return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+bool AssetPack::isPackable(const String& path)
+{
+	//images and fonts only, audio is large and decoded through its own streaming path
+	String extension = std::filesystem::path(path).extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".ttf";
+}
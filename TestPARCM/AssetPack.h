@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "SFML/Graphics.hpp"
+#include "MappedFile.h"
+
+/// <summary>
+/// Bytes of one asset. Points straight into the mapped pack when the asset is packed, otherwise into
+/// ownedBytes holding the loose file. Not copyable since data may point into ownedBytes.
+/// </summary>
+struct AssetBytes {
+	const char* data = nullptr;
+	size_t size = 0;
+	std::vector<char> ownedBytes;
+
+	AssetBytes() {}
+	AssetBytes(const AssetBytes&) = delete;
+	AssetBytes& operator=(const AssetBytes&) = delete;
+
+	bool empty() const { return this->size == 0; }
+	void clear();
+};
+
+/// <summary>
+/// Single-file archive of the images and fonts under Media, read through one memory mapping instead of opening
+/// hundreds of loose files. Layout: a 20 byte header (magic, version, entry count, directory count, table size),
+/// a table of contents (offset, size, path per entry, then modification time and path per source folder) and the
+/// file contents, each starting on a 64 byte boundary. Integers are stored little-endian. Paths are looked up in
+/// the same "Media/..." form the code loads them by; anything not in the pack falls back to the loose file.
+/// openOrBuild rebuilds the pack when a source folder's modification time changed, i.e. a file was added, removed
+/// or renamed. Editing a file in place is not detected; run with --rebuild-pack or delete the pack after that.
+/// Open it once at startup before loading anything; after that lookups are read-only and thread-safe.
+/// </summary>
+class AssetPack
+{
+public:
+	typedef std::string String;
+
+	static AssetPack* getInstance();
+	bool openOrBuild(const String& packPath, const String& sourceDirectory, bool forceRebuild = false);
+	static bool build(const String& packPath, const String& sourceDirectory);
+
+	bool find(const String& path, const char*& data, size_t& size) const;
+	bool read(const String& path, AssetBytes& bytes) const; //packed view, or the loose file read into bytes
+	int getCount() const;
+
+	//load from the pack if present, from the loose file otherwise. images decode through DecodedImageCache.
+	//a non-zero maxSize shrinks the image to fit it (0 leaves that axis free), see shrinkToFit
+	bool loadTexture(sf::Texture& texture, const String& path, const sf::Vector2u& maxSize = sf::Vector2u()) const;
+	bool loadImage(sf::Image& image, const String& path, const sf::Vector2u& maxSize = sf::Vector2u()) const;
+	bool loadFont(sf::Font& font, const String& path) const; //the font keeps reading from the mapping
+
+	//decode-time downscaling, so an image drawn smaller than its source is not minified by the GPU every frame
+	//and does not hold full size memory. both keep the aspect ratio and never upscale.
+	static bool shrinkToFit(sf::Image& image, const sf::Vector2u& maxSize); //returns true if the image was resized
+	static float shrinkToScale(sf::Image& image, float displayScale); //returns the sprite scale still to apply
+
+private:
+	AssetPack() {};
+	AssetPack(AssetPack const&) {};             // copy constructor is private
+	AssetPack& operator=(AssetPack const&) { return *this; };  // assignment operator is private
+	static AssetPack* sharedInstance;
+
+	struct Entry {
+		uint64_t offset = 0;
+		uint64_t size = 0;
+	};
+
+	struct SourceDirectory {
+		String path;
+		int64_t modifiedTime = 0; //file clock ticks when packed
+	};
+
+	bool open(const String& packPath);
+	bool isCurrent() const; //no source folder changed since the pack was built
+	static bool collectSources(const String& sourceDirectory, std::vector<String>& paths, std::vector<String>& directories); //sorted, normalized
+	static String normalizePath(const String& path);
+	static bool isPackable(const String& path);
+
+	MappedFile mapping;
+	std::unordered_map<String, Entry> entries;
+	std::vector<SourceDirectory> directories;
+
+	static const uint32_t PACK_VERSION = 3;
+	static const uint64_t BLOB_ALIGNMENT = 64;
+};
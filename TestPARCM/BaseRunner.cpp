@@ -4,6 +4,9 @@
 #include "TextureManager.h"
 #include "TextureDisplay.h"
 #include "FPSCounter.h"
+#include "MainThreadDispatcher.h"
+#include "TextureUploader.h"
+#include "AssetPack.h"
 
 /// <summary>
 /// This demonstrates a running parallax background where after X seconds, a batch of assets will be streamed and loaded.
@@ -12,7 +15,8 @@ const sf::Time BaseRunner::TIME_PER_FRAME = sf::seconds(1.f / 60.f);
 
 BaseRunner::BaseRunner() :
 	window(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "HO: Entity Component", sf::Style::Close) {
-	//load initial textures
+	//load initial textures, from the asset pack when there is one
+	AssetPack::getInstance()->openOrBuild("Media/assets.pak", "Media");
 	TextureManager::getInstance()->loadFromAssetList();
 
 	window.setFramerateLimit(144);
@@ -64,6 +68,9 @@ void BaseRunner::processEvents()
 }
 
 void BaseRunner::update(sf::Time elapsedTime) {
+	//run completions marshalled from pool workers before anything reads the object list
+	MainThreadDispatcher::getInstance()->drainQueue();
+	TextureUploader::getInstance()->processUploads();
 	GameObjectManager::getInstance()->update(elapsedTime);
 }
 
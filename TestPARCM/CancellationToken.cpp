@@ -0,0 +1,24 @@
+#include "CancellationToken.h"
+
+#include <chrono>
+
+CancellationToken::CancellationToken() {
+	this->state = std::make_shared<SharedState>();
+}
+
+void CancellationToken::Cancel() {
+	{
+		std::lock_guard<std::mutex> lock(this->state->wakeMutex);
+		this->state->cancelled = true;
+	}
+	this->state->wake.notify_all();
+}
+
+bool CancellationToken::IsCancelled() const {
+	return this->state->cancelled;
+}
+
+bool CancellationToken::SleepFor(int ms) const {
+	std::unique_lock<std::mutex> lock(this->state->wakeMutex);
+	return !this->state->wake.wait_for(lock, std::chrono::milliseconds(ms), [this] { return this->state->cancelled.load(); });
+}
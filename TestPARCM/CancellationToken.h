@@ -0,0 +1,29 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+/// <summary>
+/// Cooperative cancellation flag shared between the code that starts some work and the code doing it.
+/// Copies share the same state. Long running work checks IsCancelled between stages and uses SleepFor
+/// instead of IETThread::sleep so a cancel wakes it up immediately.
+/// </summary>
+class CancellationToken {
+public:
+	CancellationToken();
+
+	void Cancel();
+	bool IsCancelled() const;
+	bool SleepFor(int ms) const; //returns false if the token got cancelled before the time was up
+
+private:
+	struct SharedState {
+		std::atomic<bool> cancelled = false;
+		std::mutex wakeMutex;
+		std::condition_variable wake;
+	};
+
+	std::shared_ptr<SharedState> state;
+};
@@ -0,0 +1,130 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include "DecodedImageCache.h"
+#include "MappedFile.h"
+#include "MathUtils.h"
+
+namespace {
+	const char ENTRY_MAGIC[4] = { 'R', 'G', 'B', 'A' };
+
+	struct EntryHeader {
+		char magic[4];
+		uint32_t version;
+		uint64_t sourceSize;
+		int64_t sourceTime;
+		uint64_t contentHash;
+		uint32_t width;
+		uint32_t height;
+	};
+}
+
+//a singleton class. created eagerly since decoding happens on pool workers.
+DecodedImageCache* DecodedImageCache::sharedInstance = new DecodedImageCache();
+
+DecodedImageCache* DecodedImageCache::getInstance() {
+	return sharedInstance;
+}
+
+bool DecodedImageCache::decode(const String& path, const AssetBytes& bytes, sf::Image& image)
+{
+	if (bytes.empty()) return false;
+	if (bytes.size < MIN_SOURCE_BYTES) {
+		return image.loadFromMemory(bytes.data, bytes.size);
+	}
+
+	SourceInfo source;
+	source.size = bytes.size;
+	source.contentHash = MathUtils::hashFNV1a(bytes.data, bytes.size);
+	std::error_code error;
+	auto modified = std::filesystem::last_write_time(path, error);
+	if (!error) source.modifiedTime = static_cast<int64_t>(modified.time_since_epoch().count());
+
+	String entryPath = this->getEntryPath(path);
+	if (this->readEntry(entryPath, source, image)) {
+		this->hits++;
+		return true;
+	}
+
+	this->misses++;
+	if (!image.loadFromMemory(bytes.data, bytes.size)) return false;
+	this->writeEntry(entryPath, source, image);
+	return true;
+}
+
+int DecodedImageCache::getNumHits() const
+{
+	return this->hits;
+}
+
+int DecodedImageCache::getNumMisses() const
+{
+	return this->misses;
+}
+
+DecodedImageCache::String DecodedImageCache::getEntryPath(const String& path) const
+{
+	String normalized = std::filesystem::path(path).lexically_normal().generic_string();
+	std::ostringstream name;
+	name << CACHE_DIRECTORY << std::hex << std::setw(16) << std::setfill('0')
+		<< MathUtils::hashFNV1a(normalized.data(), normalized.size()) << ".rgba";
+	return name.str();
+}
+
+bool DecodedImageCache::readEntry(const String& entryPath, const SourceInfo& source, sf::Image& image)
+{
+	MappedFile file;
+	if (!file.open(entryPath) || file.getSize() < sizeof(EntryHeader)) return false;
+
+	EntryHeader header;
+	std::memcpy(&header, file.getData(), sizeof(header));
+	if (std::memcmp(header.magic, ENTRY_MAGIC, sizeof(ENTRY_MAGIC)) != 0 || header.version != ENTRY_VERSION) return false;
+
+	//stale once the source changed in any way we can see
+	if (header.sourceSize != source.size || header.sourceTime != source.modifiedTime || header.contentHash != source.contentHash) {
+		return false;
+	}
+
+	size_t pixelBytes = static_cast<size_t>(header.width) * header.height * 4;
+	if (header.width == 0 || header.height == 0 || file.getSize() != sizeof(EntryHeader) + pixelBytes) return false;
+
+	image.create(header.width, header.height, reinterpret_cast<const sf::Uint8*>(file.getData() + sizeof(EntryHeader)));
+	return true;
+}
+
+void DecodedImageCache::writeEntry(const String& entryPath, const SourceInfo& source, const sf::Image& image)
+{
+	std::error_code error;
+	std::filesystem::create_directories(CACHE_DIRECTORY, error);
+
+	EntryHeader header;
+	std::memcpy(header.magic, ENTRY_MAGIC, sizeof(ENTRY_MAGIC));
+	header.version = ENTRY_VERSION;
+	header.sourceSize = source.size;
+	header.sourceTime = source.modifiedTime;
+	header.contentHash = source.contentHash;
+	header.width = image.getSize().x;
+	header.height = image.getSize().y;
+
+	//two workers may decode the same image at once, each writes its own temp file and the last rename wins
+	std::ostringstream tempPath;
+	tempPath << entryPath << "." << std::this_thread::get_id() << ".tmp";
+	bool written = false;
+	{
+		std::ofstream stream(tempPath.str(), std::ios::binary | std::ios::trunc);
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		stream.write(reinterpret_cast<const char*>(image.getPixelsPtr()), static_cast<std::streamsize>(header.width) * header.height * 4);
+		written = static_cast<bool>(stream);
+	}
+
+	if (written) {
+		std::filesystem::rename(tempPath.str(), entryPath, error);
+	}
+	if (!written || error) {
+		std::filesystem::remove(tempPath.str(), error);
+	}
+}
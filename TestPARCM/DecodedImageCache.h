@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "SFML/Graphics.hpp"
+#include "AssetPack.h"
+
+/// <summary>
+/// On-disk cache of decoded RGBA pixels so later launches skip PNG/JPEG decoding. Each source image gets one
+/// file named after its path; the file records the source's size, modification time and a content hash, and is
+/// only used while all three still match, so editing or replacing an image invalidates it automatically.
+/// A hit maps the cache file and copies the pixels straight into the sf::Image.
+/// Small sources (the streaming tiles) decode faster than a cache lookup and bypass it.
+/// Safe to call from any thread; entries are written to a temp file and renamed into place.
+/// </summary>
+class DecodedImageCache
+{
+public:
+	typedef std::string String;
+
+	static DecodedImageCache* getInstance();
+	bool decode(const String& path, const AssetBytes& bytes, sf::Image& image); //cache hit, or decode and store
+
+	int getNumHits() const;
+	int getNumMisses() const;
+
+private:
+	DecodedImageCache() {};
+	DecodedImageCache(DecodedImageCache const&) {};             // copy constructor is private
+	DecodedImageCache& operator=(DecodedImageCache const&) { return *this; };  // assignment operator is private
+	static DecodedImageCache* sharedInstance;
+
+	struct SourceInfo {
+		uint64_t size = 0;
+		int64_t modifiedTime = 0;
+		uint64_t contentHash = 0;
+	};
+
+	String getEntryPath(const String& path) const;
+	bool readEntry(const String& entryPath, const SourceInfo& source, sf::Image& image);
+	void writeEntry(const String& entryPath, const SourceInfo& source, const sf::Image& image);
+
+	std::atomic<int> hits = 0;
+	std::atomic<int> misses = 0;
+
+	const String CACHE_DIRECTORY = "Cache/Decoded/";
+	static const size_t MIN_SOURCE_BYTES = 64 * 1024;
+	static const uint32_t ENTRY_VERSION = 1;
+};
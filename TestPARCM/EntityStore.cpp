@@ -0,0 +1,453 @@
+#include "EntityStore.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	sf::FloatRect unite(const sf::FloatRect& a, const sf::FloatRect& b)
+	{
+		float left = std::min(a.left, b.left);
+		float top = std::min(a.top, b.top);
+		float right = std::max(a.left + a.width, b.left + b.width);
+		float bottom = std::max(a.top + a.height, b.top + b.height);
+		return sf::FloatRect(left, top, right - left, bottom - top);
+	}
+}
+
+EntityStore::EntityID EntityStore::create(const TextureHandle& texture, const sf::IntRect& textureRect)
+{
+	EntityID id;
+	if (!this->freeIDs.empty()) {
+		id = this->freeIDs.back();
+		this->freeIDs.pop_back();
+	}
+	else {
+		id = static_cast<EntityID>(this->indices.size());
+		this->indices.push_back(-1);
+	}
+
+	this->indices[id] = static_cast<int>(this->owners.size());
+	this->positionsX.push_back(0.0f);
+	this->positionsY.push_back(0.0f);
+	this->scalesX.push_back(1.0f);
+	this->scalesY.push_back(1.0f);
+	this->textureRects.push_back(textureRect);
+	this->textures.push_back(texture);
+	this->flags.push_back(FLAG_VISIBLE);
+	this->staticBatchOf.push_back(-1);
+	this->owners.push_back(id);
+
+	int index = static_cast<int>(this->owners.size()) - 1;
+	this->bounds.push_back(this->computeBounds(index));
+	this->spatialHash.insert(id, this->bounds[index]);
+	return id;
+}
+
+void EntityStore::destroy(EntityID id)
+{
+	if (!this->isAlive(id)) return;
+
+	//fill the hole with the last entity so the arrays stay dense
+	int index = this->indices[id];
+	if (this->staticBatchOf[index] != -1) {
+		this->removeFromStaticBatch(this->staticBatchOf[index], id);
+	}
+	this->spatialHash.remove(id, this->bounds[index]);
+	int last = static_cast<int>(this->owners.size()) - 1;
+	if (index != last) {
+		this->positionsX[index] = this->positionsX[last];
+		this->positionsY[index] = this->positionsY[last];
+		this->scalesX[index] = this->scalesX[last];
+		this->scalesY[index] = this->scalesY[last];
+		this->textureRects[index] = this->textureRects[last];
+		this->textures[index] = std::move(this->textures[last]);
+		this->flags[index] = this->flags[last];
+		this->bounds[index] = this->bounds[last];
+		this->staticBatchOf[index] = this->staticBatchOf[last];
+		this->owners[index] = this->owners[last];
+		this->indices[this->owners[index]] = index;
+	}
+
+	this->positionsX.pop_back();
+	this->positionsY.pop_back();
+	this->scalesX.pop_back();
+	this->scalesY.pop_back();
+	this->textureRects.pop_back();
+	this->textures.pop_back();
+	this->flags.pop_back();
+	this->bounds.pop_back();
+	this->staticBatchOf.pop_back();
+	this->owners.pop_back();
+
+	this->indices[id] = -1;
+	this->freeIDs.push_back(id);
+}
+
+bool EntityStore::isAlive(EntityID id) const
+{
+	return id >= 0 && id < static_cast<EntityID>(this->indices.size()) && this->indices[id] != -1;
+}
+
+int EntityStore::size() const
+{
+	return static_cast<int>(this->owners.size());
+}
+
+void EntityStore::setPosition(EntityID id, float x, float y)
+{
+	int index = this->indices[id];
+	this->positionsX[index] = x;
+	this->positionsY[index] = y;
+	this->refreshBounds(index);
+	this->markChanged(index);
+}
+
+void EntityStore::setScale(EntityID id, float x, float y)
+{
+	int index = this->indices[id];
+	this->scalesX[index] = x;
+	this->scalesY[index] = y;
+	this->refreshBounds(index);
+	this->markChanged(index);
+}
+
+void EntityStore::setTextureRect(EntityID id, const sf::IntRect& textureRect)
+{
+	int index = this->indices[id];
+	this->textureRects[index] = textureRect;
+	this->refreshBounds(index);
+	this->markChanged(index);
+}
+
+void EntityStore::setVisible(EntityID id, bool visible)
+{
+	int index = this->indices[id];
+	uint8_t& entityFlags = this->flags[index];
+	entityFlags = visible ? (entityFlags | FLAG_VISIBLE) : (entityFlags & ~FLAG_VISIBLE);
+	this->markChanged(index);
+}
+
+void EntityStore::setStatic(EntityID id, bool isStatic)
+{
+	int index = this->indices[id];
+	uint8_t& entityFlags = this->flags[index];
+	if (((entityFlags & FLAG_STATIC) != 0) == isStatic) return;
+
+	entityFlags = isStatic ? (entityFlags | FLAG_STATIC) : (entityFlags & ~FLAG_STATIC);
+	this->placeStatic(index);
+}
+
+void EntityStore::refreshBounds(int index)
+{
+	sf::FloatRect updated = this->computeBounds(index);
+	this->spatialHash.move(this->owners[index], this->bounds[index], updated);
+	this->bounds[index] = updated;
+}
+
+void EntityStore::markChanged(int index)
+{
+	if ((this->flags[index] & FLAG_STATIC) != 0 || this->staticBatchOf[index] != -1) {
+		this->placeStatic(index);
+	}
+}
+
+bool EntityStore::getStaticKey(int index, StaticKey& key) const
+{
+	if ((this->flags[index] & (FLAG_VISIBLE | FLAG_STATIC)) != (FLAG_VISIBLE | FLAG_STATIC)) return false;
+
+	const sf::Texture* texture = this->textures[index].get();
+	if (texture == nullptr) return false;
+
+	//one batch per texture and chunk of the world, so far away geometry can be skipped as a whole
+	key = std::make_tuple(texture,
+		static_cast<int>(std::floor(this->bounds[index].left / STATIC_CHUNK_SIZE)),
+		static_cast<int>(std::floor(this->bounds[index].top / STATIC_CHUNK_SIZE)));
+	return true;
+}
+
+void EntityStore::placeStatic(int index)
+{
+	StaticKey key;
+	int target = -1;
+	if (this->getStaticKey(index, key)) {
+		auto found = this->staticBatchIndices.find(key);
+		if (found != this->staticBatchIndices.end()) {
+			target = found->second;
+		}
+		else {
+			if (!this->freeStaticBatches.empty()) {
+				target = this->freeStaticBatches.back();
+				this->freeStaticBatches.pop_back();
+			}
+			else {
+				target = static_cast<int>(this->staticBatches.size());
+				this->staticBatches.push_back(StaticBatch());
+			}
+			StaticBatch& created = this->staticBatches[target];
+			created.key = key;
+			created.texture = this->textures[index];
+			created.resolved = std::get<0>(key);
+			this->staticBatchIndices[key] = target;
+		}
+	}
+
+	int current = this->staticBatchOf[index];
+	if (current == target) {
+		//same batch, but the quad changed
+		if (current != -1) this->staticBatches[current].dirty = true;
+		return;
+	}
+
+	if (current != -1) {
+		this->removeFromStaticBatch(current, this->owners[index]);
+	}
+	this->staticBatchOf[index] = target;
+	if (target == -1) return;
+
+	//joining a batch only appends, the quads already uploaded stay where they are
+	StaticBatch& batch = this->staticBatches[target];
+	batch.members.push_back(this->owners[index]);
+	if (batch.dirty) return;
+
+	sf::Vertex quad[4];
+	this->getQuad(index, quad);
+	batch.vertices.insert(batch.vertices.end(), quad, quad + 4);
+
+	batch.bounds = batch.members.size() == 1 ? this->bounds[index] : unite(batch.bounds, this->bounds[index]);
+}
+
+void EntityStore::removeFromStaticBatch(int batchIndex, EntityID id)
+{
+	StaticBatch& batch = this->staticBatches[batchIndex];
+	auto found = std::find(batch.members.begin(), batch.members.end(), id);
+	if (found != batch.members.end()) {
+		*found = batch.members.back();
+		batch.members.pop_back();
+	}
+	this->staticBatchOf[this->indices[id]] = -1;
+	batch.dirty = true;
+
+	if (batch.members.empty()) {
+		//released so its texture can be evicted, the buffer is kept for the next batch
+		this->staticBatchIndices.erase(batch.key);
+		batch.texture.reset();
+		batch.resolved = nullptr;
+		batch.vertices.clear();
+		batch.uploaded = 0;
+		batch.dirty = false;
+		this->freeStaticBatches.push_back(batchIndex);
+	}
+}
+
+sf::Vector2f EntityStore::getPosition(EntityID id) const
+{
+	int index = this->indices[id];
+	return sf::Vector2f(this->positionsX[index], this->positionsY[index]);
+}
+
+sf::Vector2f EntityStore::getScale(EntityID id) const
+{
+	int index = this->indices[id];
+	return sf::Vector2f(this->scalesX[index], this->scalesY[index]);
+}
+
+sf::IntRect EntityStore::getTextureRect(EntityID id) const
+{
+	return this->textureRects[this->indices[id]];
+}
+
+void EntityStore::queryArea(const sf::FloatRect& area, std::vector<EntityID>& out) const
+{
+	std::vector<EntityID> candidates;
+	this->spatialHash.query(area, candidates);
+
+	out.clear();
+	for (EntityID id : candidates) {
+		int index = this->indices[id];
+		if ((this->flags[index] & FLAG_VISIBLE) != 0 && this->bounds[index].intersects(area)) {
+			out.push_back(id);
+		}
+	}
+}
+
+EntityStore::EntityID EntityStore::findAt(const sf::Vector2f& point) const
+{
+	std::vector<EntityID> candidates;
+	this->spatialHash.query(sf::FloatRect(point.x, point.y, 0.0f, 0.0f), candidates);
+
+	//dynamic entities are drawn over static ones, so they win a tie
+	EntityID found = INVALID_ENTITY;
+	for (EntityID id : candidates) {
+		int index = this->indices[id];
+		if ((this->flags[index] & FLAG_VISIBLE) == 0 || !this->bounds[index].contains(point)) continue;
+
+		if ((this->flags[index] & FLAG_STATIC) == 0) return id;
+		found = id;
+	}
+	return found;
+}
+
+void EntityStore::draw(sf::RenderTarget& target)
+{
+	sf::FloatRect visibleArea = getVisibleArea(target);
+	this->drawStatic(target, visibleArea);
+
+	for (Batch& batch : this->batches) {
+		batch.vertices.clear();
+	}
+	this->batchIndices.clear();
+
+	//only what overlaps the view, in store order so batches come out the same from frame to frame
+	this->spatialHash.query(visibleArea, this->visibleIDs);
+	this->visibleIndices.clear();
+	for (EntityID id : this->visibleIDs) {
+		this->visibleIndices.push_back(this->indices[id]);
+	}
+	std::sort(this->visibleIndices.begin(), this->visibleIndices.end());
+
+	int used = 0;
+	sf::Vertex quad[4];
+	for (int i : this->visibleIndices) {
+		if ((this->flags[i] & (FLAG_VISIBLE | FLAG_STATIC)) != FLAG_VISIBLE) continue;
+		if (!this->bounds[i].intersects(visibleArea)) continue;
+
+		//NULL when the texture was unloaded underneath the entity
+		const sf::Texture* texture = this->textures[i].get();
+		if (texture == nullptr) continue;
+
+		auto found = this->batchIndices.find(texture);
+		int batchIndex;
+		if (found != this->batchIndices.end()) {
+			batchIndex = found->second;
+		}
+		else {
+			batchIndex = used++;
+			if (batchIndex == static_cast<int>(this->batches.size())) {
+				this->batches.push_back(Batch());
+			}
+			this->batches[batchIndex].texture = texture;
+			this->batchIndices[texture] = batchIndex;
+		}
+
+		this->getQuad(i, quad);
+		sf::VertexArray& vertices = this->batches[batchIndex].vertices;
+		for (int v = 0; v < 4; v++) {
+			vertices.append(quad[v]);
+		}
+	}
+
+	//one draw call per texture instead of one per entity
+	for (int b = 0; b < used; b++) {
+		sf::RenderStates states;
+		states.texture = this->batches[b].texture;
+		target.draw(this->batches[b].vertices, states);
+	}
+	this->drawCalls += used;
+}
+
+int EntityStore::getDrawCalls() const
+{
+	return this->drawCalls;
+}
+
+void EntityStore::getQuad(size_t index, sf::Vertex* quad) const
+{
+	const sf::IntRect& rect = this->textureRects[index];
+	float left = this->positionsX[index];
+	float top = this->positionsY[index];
+	float right = left + rect.width * this->scalesX[index];
+	float bottom = top + rect.height * this->scalesY[index];
+
+	float u0 = static_cast<float>(rect.left);
+	float v0 = static_cast<float>(rect.top);
+	float u1 = static_cast<float>(rect.left + rect.width);
+	float v1 = static_cast<float>(rect.top + rect.height);
+
+	quad[0] = sf::Vertex(sf::Vector2f(left, top), sf::Vector2f(u0, v0));
+	quad[1] = sf::Vertex(sf::Vector2f(right, top), sf::Vector2f(u1, v0));
+	quad[2] = sf::Vertex(sf::Vector2f(right, bottom), sf::Vector2f(u1, v1));
+	quad[3] = sf::Vertex(sf::Vector2f(left, bottom), sf::Vector2f(u0, v1));
+}
+
+sf::FloatRect EntityStore::computeBounds(size_t index) const
+{
+	const sf::IntRect& rect = this->textureRects[index];
+	float width = rect.width * this->scalesX[index];
+	float height = rect.height * this->scalesY[index];
+
+	//a negative scale flips the quad to the other side of the position
+	float left = std::min(this->positionsX[index], this->positionsX[index] + width);
+	float top = std::min(this->positionsY[index], this->positionsY[index] + height);
+	return sf::FloatRect(left, top, std::fabs(width), std::fabs(height));
+}
+
+sf::FloatRect EntityStore::getVisibleArea(const sf::RenderTarget& target)
+{
+	//the view's clip space square mapped back to world space, also right for rotated views
+	return target.getView().getInverseTransform().transformRect(sf::FloatRect(-1.0f, -1.0f, 2.0f, 2.0f));
+}
+
+void EntityStore::drawStatic(sf::RenderTarget& target, const sf::FloatRect& visibleArea)
+{
+	this->drawCalls = 0;
+
+	//the batches hold raw texture pointers. when one was unloaded since, its members are placed again,
+	//which drops them if their texture is gone for good. batches may be added while this runs
+	for (size_t b = 0; b < this->staticBatches.size(); b++) {
+		StaticBatch& batch = this->staticBatches[b];
+		if (batch.members.empty() || batch.texture.get() == batch.resolved) continue;
+
+		std::vector<EntityID> members = batch.members;
+		for (EntityID id : members) {
+			this->removeFromStaticBatch(static_cast<int>(b), id);
+		}
+		for (EntityID id : members) {
+			this->placeStatic(this->indices[id]);
+		}
+	}
+
+	int submitted = 0;
+	for (StaticBatch& batch : this->staticBatches) {
+		if (batch.members.empty()) continue;
+		this->uploadStatic(batch);
+		if (!batch.bounds.intersects(visibleArea)) continue;
+
+		submitted++;
+		sf::RenderStates states;
+		states.texture = batch.resolved;
+		if (sf::VertexBuffer::isAvailable()) {
+			target.draw(batch.buffer, 0, batch.vertices.size(), states);
+		}
+		else {
+			target.draw(batch.vertices.data(), batch.vertices.size(), sf::Quads, states);
+		}
+	}
+	this->drawCalls += submitted;
+}
+
+void EntityStore::uploadStatic(StaticBatch& batch)
+{
+	if (batch.dirty) {
+		batch.vertices.clear();
+		batch.uploaded = 0;
+		sf::Vertex quad[4];
+		for (size_t m = 0; m < batch.members.size(); m++) {
+			int index = this->indices[batch.members[m]];
+			this->getQuad(index, quad);
+			batch.vertices.insert(batch.vertices.end(), quad, quad + 4);
+
+			batch.bounds = m == 0 ? this->bounds[index] : unite(batch.bounds, this->bounds[index]);
+		}
+		batch.dirty = false;
+	}
+
+	if (!sf::VertexBuffer::isAvailable() || batch.uploaded == batch.vertices.size()) return;
+
+	//grows by doubling so a batch filling up one quad at a time does not reallocate every frame.
+	//create drops the old contents, everything goes up again after it
+	if (batch.buffer.getVertexCount() < batch.vertices.size()) {
+		batch.buffer.create(std::max(batch.vertices.size(), batch.buffer.getVertexCount() * 2));
+		batch.uploaded = 0;
+	}
+	batch.buffer.update(batch.vertices.data() + batch.uploaded, batch.vertices.size() - batch.uploaded, static_cast<unsigned int>(batch.uploaded));
+	batch.uploaded = batch.vertices.size();
+}
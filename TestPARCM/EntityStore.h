@@ -0,0 +1,113 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include "SFML/Graphics.hpp"
+#include "TextureHandle.h"
+#include "SpatialHash.h"
+
+/// <summary>
+/// Structure-of-arrays storage for game objects that are nothing more than a textured quad. Every component
+/// (position, scale, texture rect, texture, flags) lives in its own dense array, so drawing walks memory
+/// linearly instead of visiting one heap object, one sprite and one virtual call per entity.
+/// Destroying an entity moves the last one into the hole; ids stay stable through an id to index table and
+/// are reused once freed. Main thread only.
+/// Drawing batches every visible entity into one quad list per texture (streamed tiles share atlas pages, so
+/// a whole grid is a handful of draw calls). Entities are therefore not ordered among themselves; overlapping
+/// entities on different textures draw in order of the texture's first appearance.
+/// Entities flagged static are expected to stay put. Their quads live in one sf::VertexBuffer per texture and
+/// drawn from there every frame. A new static entity only appends its quad to its batch's buffer; moving,
+/// hiding or destroying one re-uploads just the batch it was in. Static geometry is drawn before the dynamic
+/// batches.
+/// Entity bounds are kept in a SpatialHash. Drawing only gathers dynamic entities that overlap the target's
+/// view, and static geometry is split into STATIC_CHUNK_SIZE regions whose buffers are skipped when they are
+/// out of view. Hit tests use the same hash.
+/// </summary>
+class EntityStore
+{
+public:
+	typedef int EntityID;
+	static const EntityID INVALID_ENTITY = -1;
+	enum EntityFlags : uint8_t { FLAG_VISIBLE = 1, FLAG_STATIC = 2 };
+
+	EntityID create(const TextureHandle& texture, const sf::IntRect& textureRect);
+	void destroy(EntityID id);
+	bool isAlive(EntityID id) const;
+	int size() const;
+
+	void setPosition(EntityID id, float x, float y);
+	void setScale(EntityID id, float x, float y);
+	void setTextureRect(EntityID id, const sf::IntRect& textureRect);
+	void setVisible(EntityID id, bool visible);
+	void setStatic(EntityID id, bool isStatic);
+	sf::Vector2f getPosition(EntityID id) const;
+	sf::Vector2f getScale(EntityID id) const;
+	sf::IntRect getTextureRect(EntityID id) const;
+
+	void queryArea(const sf::FloatRect& area, std::vector<EntityID>& out) const; //visible entities overlapping area
+	EntityID findAt(const sf::Vector2f& point) const; //a visible entity under point, dynamic ones first
+
+	void draw(sf::RenderTarget& target);
+	int getDrawCalls() const; //batches submitted by the last draw, static ones included
+
+private:
+	//index i of every array below is the same entity
+	std::vector<float> positionsX;
+	std::vector<float> positionsY;
+	std::vector<float> scalesX;
+	std::vector<float> scalesY;
+	std::vector<sf::IntRect> textureRects;
+	std::vector<TextureHandle> textures;
+	std::vector<uint8_t> flags;
+	std::vector<sf::FloatRect> bounds; //world space, what the spatial hash was last told
+	std::vector<int> staticBatchOf; //static batch holding the entity's quad, -1 if none
+	std::vector<EntityID> owners; //dense index to id
+
+	std::vector<int> indices; //id to dense index, -1 while the id is free
+	std::vector<EntityID> freeIDs;
+
+	static constexpr float CELL_SIZE = 128.0f; //about two icon cells
+	static constexpr float STATIC_CHUNK_SIZE = 1024.0f;
+	SpatialHash spatialHash = SpatialHash(CELL_SIZE);
+	std::vector<EntityID> visibleIDs; //scratch for draw
+	std::vector<int> visibleIndices;
+
+	//kept between frames so the vertex storage is reused instead of reallocated
+	struct Batch {
+		const sf::Texture* texture = nullptr;
+		sf::VertexArray vertices = sf::VertexArray(sf::Quads);
+	};
+	std::vector<Batch> batches;
+	std::unordered_map<const sf::Texture*, int> batchIndices;
+	int drawCalls = 0;
+
+	typedef std::tuple<const sf::Texture*, int, int> StaticKey; //texture and chunk column, row
+
+	struct StaticBatch {
+		StaticKey key;
+		TextureHandle texture; //checked every draw, an unloaded texture regroups the batch
+		const sf::Texture* resolved = nullptr;
+		std::vector<EntityID> members;
+		sf::FloatRect bounds; //of every quad in the batch, for culling the whole buffer
+		std::vector<sf::Vertex> vertices; //also drawn directly on drivers without vertex buffer support
+		size_t uploaded = 0; //leading vertices already in the buffer
+		bool dirty = false; //a member moved or left, vertices are gathered again before the next upload
+		sf::VertexBuffer buffer = sf::VertexBuffer(sf::Quads, sf::VertexBuffer::Static);
+	};
+	std::vector<StaticBatch> staticBatches;
+	std::map<StaticKey, int> staticBatchIndices;
+	std::vector<int> freeStaticBatches; //emptied batches, their buffers are reused
+
+	void getQuad(size_t index, sf::Vertex* quad) const;
+	sf::FloatRect computeBounds(size_t index) const;
+	void refreshBounds(int index);
+	static sf::FloatRect getVisibleArea(const sf::RenderTarget& target);
+	void markChanged(int index); //moves a static entity's quad to the batch it now belongs in, or marks it dirty
+	bool getStaticKey(int index, StaticKey& key) const; //false if the entity is not drawn as static geometry
+	void placeStatic(int index);
+	void removeFromStaticBatch(int batchIndex, EntityID id);
+	void uploadStatic(StaticBatch& batch);
+	void drawStatic(sf::RenderTarget& target, const sf::FloatRect& visibleArea);
+};
@@ -1,4 +1,5 @@
 #include "FPSCounter.h"
+#include "AssetPack.h"
 #include <iostream>
 #include "BaseRunner.h"
 #include "string.h"
@@ -18,7 +19,7 @@ void FPSCounter::initialize()
 {
 	sf::Font* font = new sf::Font();
 	//font->loadFromFile("C:\\Coding\\GDPARCM\\TestPARCM\\TestPARCM\\Media\\Sansation.ttf");
-	font->loadFromFile("Media/Sansation.ttf");
+	AssetPack::getInstance()->loadFont(*font, "Media/Sansation.ttf");
 
 	this->statsText = new sf::Text();
 	this->statsText->setFont(*font);
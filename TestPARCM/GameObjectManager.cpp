@@ -15,13 +15,26 @@ GameObjectManager* GameObjectManager::getInstance() {
 
 AGameObject* GameObjectManager::findObjectByName(AGameObject::String name)
 {
-	if (this->gameObjectMap[name] != NULL) {
-		return this->gameObjectMap[name];
-	}
-	else {
+	//find, not operator[], a miss must not leave an entry behind
+	HashTable::iterator found = this->gameObjectMap.find(name);
+	AGameObject* object = found != this->gameObjectMap.end() ? this->findObject(found->second) : NULL;
+	if (object == NULL) {
 		std::cout << "Object " << name << " not found!";
-		return NULL;
 	}
+	return object;
+}
+
+AGameObject* GameObjectManager::findObject(ObjectHandle handle)
+{
+	ObjectSlot* slot = this->resolve(handle);
+	return slot != NULL ? slot->object : NULL;
+}
+
+AGameObject* GameObjectManager::findObjectAt(sf::Vector2f point)
+{
+	EntityStore::EntityID id = this->entityStore.findAt(point);
+	if (id == EntityStore::INVALID_ENTITY) return NULL;
+	return this->entityOwners[id];
 }
 
 List GameObjectManager::getAllObjects()
@@ -35,54 +48,166 @@ int GameObjectManager::activeObjects()
 }
 
 void GameObjectManager::processInput(sf::Event event) {
-	for (int i = 0; i < this->gameObjectList.size(); i++) {
-		this->gameObjectList[i]->processInput(event);
+	this->compactLists();
+	for (int i = 0; i < this->behaviourList.size(); i++) {
+		if (this->behaviourList[i] != NULL) this->behaviourList[i]->processInput(event);
 	}
 }
 
 void GameObjectManager::update(sf::Time deltaTime)
 {
 	//std::cout << "Delta time: " << deltaTime.asSeconds() << "\n";
-	for (int i = 0; i < this->gameObjectList.size(); i++) {
-		this->gameObjectList[i]->update(deltaTime);
+	this->compactLists();
+	for (int i = 0; i < this->behaviourList.size(); i++) {
+		if (this->behaviourList[i] != NULL) this->behaviourList[i]->update(deltaTime);
 	}
 }
 
 //draws the object if it contains a sprite
 void GameObjectManager::draw(sf::RenderWindow* window) {
-	for (int i = 0; i < this->gameObjectList.size(); i++) {
-		this->gameObjectList[i]->draw(window);
+	this->compactLists();
+	for (int i = 0; i < this->drawList.size(); i++) {
+		if (this->drawList[i] != NULL) this->drawList[i]->draw(window);
 	}
+	this->entityStore.draw(*window);
 }
 
-void GameObjectManager::addObject(AGameObject* gameObject)
+ObjectHandle GameObjectManager::addObject(AGameObject* gameObject)
 {
-	//also initialize the oject
-	this->gameObjectMap[gameObject->getName()] = gameObject;
+	uint32_t index;
+	if (!this->freeSlots.empty()) {
+		index = this->freeSlots.back();
+		this->freeSlots.pop_back();
+	}
+	else {
+		index = static_cast<uint32_t>(this->slots.size());
+		this->slots.push_back(ObjectSlot());
+	}
+
+	ObjectHandle handle;
+	handle.index = index;
+	handle.generation = this->slots[index].generation;
+	gameObject->handle = handle;
+	this->slots[index].object = gameObject;
+	this->slots[index].listIndex = static_cast<int>(this->gameObjectList.size());
 	this->gameObjectList.push_back(gameObject);
-	this->gameObjectMap[gameObject->getName()]->initialize();
+	this->gameObjectMap[gameObject->getName()] = handle;
+
+	//also initialize the oject. it may add objects of its own, so slots is indexed again afterwards
+	gameObject->initialize();
+
+	//initialize decides whether the object became an entity
+	if (gameObject->runsBehaviour()) {
+		this->slots[index].behaviourIndex = static_cast<int>(this->behaviourList.size());
+		this->behaviourList.push_back(gameObject);
+	}
+	EntityStore::EntityID entityID = gameObject->getEntityID();
+	if (entityID == EntityStore::INVALID_ENTITY) {
+		this->slots[index].drawIndex = static_cast<int>(this->drawList.size());
+		this->drawList.push_back(gameObject);
+	}
+	else {
+		if (entityID >= static_cast<int>(this->entityOwners.size())) {
+			this->entityOwners.resize(entityID + 1, NULL);
+		}
+		this->entityOwners[entityID] = gameObject;
+	}
+
+	return handle;
 }
 
 //also frees up allocation of the object.
 void GameObjectManager::deleteObject(AGameObject* gameObject)
 {
-	this->gameObjectMap.erase(gameObject->getName());
+	ObjectSlot* slot = this->resolve(gameObject->handle);
+	if (slot != NULL && slot->object == gameObject) {
+		HashTable::iterator named = this->gameObjectMap.find(gameObject->getName());
+		if (named != this->gameObjectMap.end() && named->second == gameObject->handle) {
+			this->gameObjectMap.erase(named);
+		}
 
-	int index = -1;
-	for (int i = 0; i < this->gameObjectList.size(); i++) {
-		if (this->gameObjectList[i] == gameObject) {
-			index = i;
-			break;
+		//the last object fills the hole, iteration order over gameObjectList is not kept
+		AGameObject* last = this->gameObjectList.back();
+		this->gameObjectList[slot->listIndex] = last;
+		this->slots[last->handle.index].listIndex = slot->listIndex;
+		this->gameObjectList.pop_back();
+
+		//input, update and draw order is kept, the holes are squeezed out before the next pass
+		if (slot->behaviourIndex != -1) {
+			this->behaviourList[slot->behaviourIndex] = NULL;
+			this->behaviourHoles++;
+		}
+		if (slot->drawIndex != -1) {
+			this->drawList[slot->drawIndex] = NULL;
+			this->drawHoles++;
 		}
+
+		slot->object = NULL;
+		slot->generation++;
+		slot->listIndex = -1;
+		slot->behaviourIndex = -1;
+		slot->drawIndex = -1;
+		this->freeSlots.push_back(gameObject->handle.index);
+		gameObject->handle = ObjectHandle();
 	}
 
-	if (index != -1) {
-		this->gameObjectList.erase(this->gameObjectList.begin() + index);
+	if (gameObject->getEntityID() != EntityStore::INVALID_ENTITY) {
+		this->entityOwners[gameObject->getEntityID()] = NULL;
+		this->entityStore.destroy(gameObject->getEntityID());
 	}
 	
 	delete gameObject;
 }
 
+void GameObjectManager::deleteObject(ObjectHandle handle)
+{
+	AGameObject* object = this->findObject(handle);
+
+	if (object != NULL) {
+		this->deleteObject(object);
+	}
+}
+
+EntityStore* GameObjectManager::getEntityStore()
+{
+	return &this->entityStore;
+}
+
+GameObjectManager::ObjectSlot* GameObjectManager::resolve(ObjectHandle handle)
+{
+	if (handle.index >= this->slots.size()) return NULL;
+	ObjectSlot& slot = this->slots[handle.index];
+	if (slot.generation != handle.generation || slot.object == NULL) return NULL;
+	return &slot;
+}
+
+void GameObjectManager::compactLists()
+{
+	if (this->behaviourHoles > 0) {
+		int kept = 0;
+		for (int i = 0; i < this->behaviourList.size(); i++) {
+			AGameObject* object = this->behaviourList[i];
+			if (object == NULL) continue;
+			this->slots[object->handle.index].behaviourIndex = kept;
+			this->behaviourList[kept++] = object;
+		}
+		this->behaviourList.resize(kept);
+		this->behaviourHoles = 0;
+	}
+
+	if (this->drawHoles > 0) {
+		int kept = 0;
+		for (int i = 0; i < this->drawList.size(); i++) {
+			AGameObject* object = this->drawList[i];
+			if (object == NULL) continue;
+			this->slots[object->handle.index].drawIndex = kept;
+			this->drawList[kept++] = object;
+		}
+		this->drawList.resize(kept);
+		this->drawHoles = 0;
+	}
+}
+
 void GameObjectManager::deleteObjectByName(AGameObject::String name) {
 	AGameObject* object = this->findObjectByName(name);
 	
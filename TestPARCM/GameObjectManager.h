@@ -1,14 +1,24 @@
 #pragma once
 //singleton class
-/* Game object manager contains all of the declared game object classes and calls the update function
+/* Game object manager contains all of the declared game object classes and calls the update function.
+ * Objects without behaviour are left out of the input and update passes, and objects that turned themselves
+ * into entities are drawn after the rest by the EntityStore, batched into one draw call per texture and culled
+ * to the view. Hit tests only see entities.
+ * Objects live in a slot map: adding, deleting and resolving an ObjectHandle are O(1). The object list stays
+ * dense for iteration, and deleting swaps the last object into the hole, so getAllObjects is not in insertion
+ * order. The input, update and draw lists keep their order; a deleted object leaves a NULL behind that is
+ * skipped and squeezed out before the next pass, so objects may delete each other mid-update.
  */
 #include <unordered_map>
 #include <vector>
 #include <string>
+#include <cstdint>
 #include "AGameObject.h"
+#include "ObjectHandle.h"
+#include "EntityStore.h"
 #include <SFML/Graphics.hpp>
 
-typedef std::unordered_map<std::string, AGameObject*> HashTable;
+typedef std::unordered_map<std::string, ObjectHandle> HashTable;
 typedef std::vector<AGameObject*> List;
 
 class GameObjectManager
@@ -16,22 +26,45 @@ class GameObjectManager
 	public:
 		static GameObjectManager* getInstance();
 		AGameObject* findObjectByName(AGameObject::String name);
+		AGameObject* findObject(ObjectHandle handle); //NULL once the object was deleted
+		AGameObject* findObjectAt(sf::Vector2f point); //world coordinates, NULL when no entity is there
 		List getAllObjects();
 		int activeObjects();
 		void processInput(sf::Event event);
 		void update(sf::Time deltaTime);
 		void draw(sf::RenderWindow* window);
-		void addObject(AGameObject* gameObject);
+		ObjectHandle addObject(AGameObject* gameObject);
 		void deleteObject(AGameObject* gameObject);
+		void deleteObject(ObjectHandle handle);
 		void deleteObjectByName(AGameObject::String name);
+		EntityStore* getEntityStore();
 
 	private:
 		GameObjectManager() {};
 		GameObjectManager(GameObjectManager const&) {};             // copy constructor is private
-		GameObjectManager& operator=(GameObjectManager const&) {};  // assignment operator is private
+		GameObjectManager& operator=(GameObjectManager const&) { return *this; };  // assignment operator is private
 		static GameObjectManager* sharedInstance;
 
-		HashTable gameObjectMap;
+		struct ObjectSlot {
+			AGameObject* object = NULL;
+			uint32_t generation = 1;
+			int listIndex = -1; //position in gameObjectList
+			int behaviourIndex = -1;
+			int drawIndex = -1;
+		};
+
+		std::vector<ObjectSlot> slots;
+		std::vector<uint32_t> freeSlots;
+		HashTable gameObjectMap; //name to handle, duplicate names resolve to the newest object
 		List gameObjectList;
+		List behaviourList; //objects that still need processInput and update every frame
+		List drawList; //objects that draw themselves, entities are drawn by the store
+		int behaviourHoles = 0;
+		int drawHoles = 0;
+		EntityStore entityStore;
+		List entityOwners; //indexed by entity id
+
+		ObjectSlot* resolve(ObjectHandle handle);
+		void compactLists(); //drops the NULLs deleted objects left in behaviourList and drawList
 };
 
@@ -6,14 +6,16 @@
 IconObject::IconObject(String name, int textureIndex): AGameObject(name)
 {
 	this->textureIndex = textureIndex;
+	this->hasBehaviour = false;
 }
 
 void IconObject::initialize()
 {
-	//assign texture
-	this->sprite = new sf::Sprite();
-	sf::Texture* texture = TextureManager::getInstance()->getStreamTextureFromList(this->textureIndex);
-	this->sprite->setTexture(*texture);
+	//streaming tiles share atlas pages, so consecutive icons draw without switching textures
+	TextureHandle texture = TextureManager::getInstance()->getStreamTextureFromList(this->textureIndex);
+	if (!texture.isValid()) return;
+	//the grid cell is fixed once spawned, so the quad is uploaded once rather than rebuilt every frame
+	this->makeEntity(texture, texture.getRect(), true);
 }
 
 void IconObject::processInput(sf::Event event)
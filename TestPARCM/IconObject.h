@@ -1,5 +1,9 @@
 #pragma once
 #include "AGameObject.h"
+/// <summary>
+/// One streamed tile in the TextureDisplay grid. Lives in the EntityStore as a static textured quad; it has no
+/// per-frame behaviour and no sprite of its own.
+/// </summary>
 class IconObject :    public AGameObject
 {
 public:
@@ -0,0 +1,12 @@
+#pragma once
+
+/// <summary>
+/// Times every MathUtils image kernel at each SIMD level the CPU supports and prints the results next to the
+/// scalar baseline, checking along the way that the vector paths produce the same bytes.
+/// Run with: TestPARCM --bench-image
+/// </summary>
+class ImageBenchmark
+{
+public:
+	static void run();
+};
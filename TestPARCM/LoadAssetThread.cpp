@@ -1,4 +1,5 @@
 #include "LoadAssetThread.h"
+#include "ThreadPool.h"
 
 LoadAssetThread::LoadAssetThread() {}
 
@@ -14,9 +15,49 @@ LoadAssetThread::LoadAssetThread(int _id, IExecutionEvent* _callback) {
 	this->onFinished = _callback;
 }
 
+LoadAssetThread::LoadAssetThread(int _id, IExecutionEvent* _callback, CancellationToken _token) {
+	this->id = _id;
+	this->onFinished = _callback;
+	this->token = _token;
+}
+
+LoadAssetThread::LoadAssetThread(int _id, IExecutionEvent* _callback, ThreadPool* _pool, int _intervalMs, CancellationToken _token) {
+	this->id = _id;
+	this->onFinished = _callback;
+	this->pool = _pool;
+	this->intervalMs = _intervalMs;
+	this->token = _token;
+}
 
 void LoadAssetThread::OnStartTask() {
-	TextureManager::getInstance()->loadStreamingAssets(this->id);
+	if (this->pool != nullptr) {
+		this->loadNextThrottled();
+		return;
+	}
+
+	TextureManager::getInstance()->loadStreamingAssets(this->id, this->token);
+	if (this->token.IsCancelled()) return;
+
 	this->onFinished->OnFinishedExecution();
 	//delete this;
+}
+
+void LoadAssetThread::loadNextThrottled() {
+	if (this->token.IsCancelled()) return;
+
+	if (this->nextIndex == 0) {
+		this->paths = TextureManager::getInstance()->getStreamingAssetPaths(this->id);
+	}
+
+	if (this->nextIndex < static_cast<int>(this->paths.size())) {
+		TextureManager::getInstance()->loadStreamingAsset(this->paths[this->nextIndex]);
+		this->nextIndex++;
+	}
+
+	if (this->nextIndex < static_cast<int>(this->paths.size())) {
+		this->pool->ScheduleDelayed(this, this->intervalMs, PRIORITY_LOW);
+	}
+	else {
+		this->onFinished->OnFinishedExecution();
+	}
 }
\ No newline at end of file
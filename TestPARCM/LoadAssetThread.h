@@ -5,18 +5,34 @@
 #include "IWorkerAction.h"
 #include "IExecutionEvent.h"
 #include "TextureManager.h"
+#include "CancellationToken.h"
 
+class ThreadPool;
+
+/// <summary>
+/// Loads a batch of streaming textures. With a pool and an interval it loads one file per run and
+/// reschedules itself as a delayed task, so the throttling costs no worker time.
+/// </summary>
 class LoadAssetThread : public IWorkerAction {
 public:
 	LoadAssetThread();
 	LoadAssetThread(IExecutionEvent* _callback);
 	LoadAssetThread(int _id, IExecutionEvent* _callback);
+	LoadAssetThread(int _id, IExecutionEvent* _callback, CancellationToken _token);
+	LoadAssetThread(int _id, IExecutionEvent* _callback, ThreadPool* _pool, int _intervalMs, CancellationToken _token = CancellationToken());
 	~LoadAssetThread();
 
 private:
 	int id;
+	CancellationToken token;
+
+	ThreadPool* pool = nullptr;
+	int intervalMs = 0;
+	int nextIndex = 0;
+	std::vector<std::string> paths;
 
 	void OnStartTask() override;
+	void loadNextThrottled();
 	IExecutionEvent* onFinished;
 };
 
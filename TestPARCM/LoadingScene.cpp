@@ -1,24 +1,29 @@
 // LoadingScene.cpp
 #include "LoadingScene.h"
+#include "AssetPack.h"
 #include <iostream>
 #include <cmath>
 #include <algorithm>
 
 LoadingScene::LoadingScene(sf::RenderWindow* window) : window(window) {
     const std::string vinylPath = "Media/Textures/pngimg.com - vinyl_PNG18.png";
-    if (!vinylTexture.loadFromFile(vinylPath)) {
+    sf::Image vinylImage;
+    if (!AssetPack::getInstance()->loadImage(vinylImage, vinylPath)) {
         std::cerr << "LoadingScene: failed to load vinyl texture: " << vinylPath << '\n';
     }
     else {
-        vinylSprite.setTexture(vinylTexture);
+        //752px source shown at 0.4, shrink once here instead of minifying it every frame
+        vinylSpriteScale = AssetPack::shrinkToScale(vinylImage, vinylScale);
+        vinylTexture.loadFromImage(vinylImage);
+        vinylSprite.setTexture(vinylTexture, true);
         sf::FloatRect b = vinylSprite.getLocalBounds();
         vinylSprite.setOrigin(b.left + b.width / 2.0f, b.top + b.height / 2.0f);
-        vinylSprite.setScale(vinylScale, vinylScale);
-        vinylRadius = (std::max(b.width, b.height) * vinylScale) / 2.0f;
+        vinylSprite.setScale(vinylSpriteScale, vinylSpriteScale);
+        vinylRadius = (std::max(b.width, b.height) * vinylSpriteScale) / 2.0f;
     }
 
     const std::string fontPath = "Media/Sansation.ttf";
-    if (!font.loadFromFile(fontPath)) {
+    if (!AssetPack::getInstance()->loadFont(font, fontPath)) {
         std::cerr << "LoadingScene: failed to load font: " << fontPath << '\n';
     }
 
@@ -43,7 +48,8 @@ LoadingScene::LoadingScene(sf::RenderWindow* window) : window(window) {
     const float multipliers[3] = { 0.35f, 0.65f, 1.0f };
 
     for (int i = 0; i < 3; ++i) {
-        if (!bgLayers[i].texture.loadFromFile(bgPaths[i])) {
+        //backgrounds are drawn at window height, a taller source is shrunk to it on load
+        if (!AssetPack::getInstance()->loadTexture(bgLayers[i].texture, bgPaths[i], sf::Vector2u(0, window->getSize().y))) {
             std::cerr << "LoadingScene: failed to load background: " << bgPaths[i] << '\n';
         }
         else {
@@ -81,8 +87,8 @@ void LoadingScene::start() {
 
     if (vinylTexture.getSize().x > 0 && vinylTexture.getSize().y > 0) {
         sf::FloatRect b = vinylSprite.getLocalBounds();
-        vinylSprite.setScale(vinylScale, vinylScale);
-        vinylRadius = (std::max(b.width, b.height) * vinylScale) / 2.0f;
+        vinylSprite.setScale(vinylSpriteScale, vinylSpriteScale);
+        vinylRadius = (std::max(b.width, b.height) * vinylSpriteScale) / 2.0f;
     }
 
     for (auto& layer : bgLayers) {
@@ -24,7 +24,8 @@ private:
     sf::Texture vinylTexture;
     sf::Sprite vinylSprite;
     float vinylRadius = 120.0f;
-    float vinylScale = 0.4f;
+    float vinylScale = 0.4f; //on-screen size relative to the source image
+    float vinylSpriteScale = 0.4f; //what is left of vinylScale after the image was shrunk on load
     float basePassiveSpin = 20.0f;
     float angularVelocity = 0.0f;
     bool draggingVinyl = false;
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// Bounded lock-free multi-producer/multi-consumer ring (Vyukov's sequence-numbered cells). Every cell carries
+/// a sequence number that tells producers and consumers whether it is free or filled for the current lap,
+/// so TryEnqueue and TryDequeue need a single CAS on the shared position and never block.
+/// Both fail instead of waiting when the ring is full or empty. Capacity is rounded up to a power of two.
+/// </summary>
+template <typename T>
+class MPMCQueue {
+public:
+	MPMCQueue(size_t _capacity) {
+		size_t capacity = 2;
+		while (capacity < _capacity) capacity <<= 1;
+
+		this->mask = capacity - 1;
+		this->cells = std::vector<Cell>(capacity);
+		for (size_t i = 0; i < capacity; i++) {
+			this->cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	MPMCQueue(const MPMCQueue&) = delete;
+	MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+	bool TryEnqueue(T _item) {
+		size_t pos = this->enqueuePos.load(std::memory_order_relaxed);
+		Cell* cell;
+
+		while (true) {
+			cell = &this->cells[pos & this->mask];
+			size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+			if (diff == 0) {
+				if (this->enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+			}
+			else if (diff < 0) {
+				return false; //full
+			}
+			else {
+				pos = this->enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		cell->data = std::move(_item);
+		cell->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool TryDequeue(T& _item) {
+		size_t pos = this->dequeuePos.load(std::memory_order_relaxed);
+		Cell* cell;
+
+		while (true) {
+			cell = &this->cells[pos & this->mask];
+			size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+
+			if (diff == 0) {
+				if (this->dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+			}
+			else if (diff < 0) {
+				return false; //empty
+			}
+			else {
+				pos = this->dequeuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		_item = std::move(cell->data);
+		cell->data = T();
+		cell->sequence.store(pos + this->mask + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	struct Cell {
+		std::atomic<size_t> sequence;
+		T data;
+
+		Cell() : sequence(0), data() {}
+		Cell(const Cell& other) : sequence(other.sequence.load()), data(other.data) {}
+	};
+
+	std::vector<Cell> cells;
+	size_t mask = 0;
+
+	//kept on separate cache lines so producers and consumers do not false-share
+	alignas(64) std::atomic<size_t> enqueuePos = 0;
+	alignas(64) std::atomic<size_t> dequeuePos = 0;
+};
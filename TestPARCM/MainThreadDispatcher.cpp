@@ -0,0 +1,58 @@
+#include "MainThreadDispatcher.h"
+#include <iterator>
+
+//a singleton class. created eagerly since worker threads may be the first to post into it.
+MainThreadDispatcher* MainThreadDispatcher::sharedInstance = new MainThreadDispatcher();
+
+MainThreadDispatcher* MainThreadDispatcher::getInstance() {
+	return sharedInstance;
+}
+
+void MainThreadDispatcher::post(Callback callback)
+{
+	if (this->completions.TryEnqueue(callback)) return;
+
+	std::lock_guard<std::mutex> lock(this->overflowMutex);
+	this->overflowCallbacks.push_back(std::move(callback));
+	this->hasOverflow = true;
+}
+
+TimerQueue::TimerID MainThreadDispatcher::postDelayed(Callback callback, int delayMs)
+{
+	return this->timers.Add(std::move(callback), delayMs);
+}
+
+TimerQueue::TimerID MainThreadDispatcher::postPeriodic(Callback callback, int periodMs)
+{
+	return this->timers.Add(std::move(callback), periodMs, periodMs);
+}
+
+void MainThreadDispatcher::cancelTimer(TimerQueue::TimerID id)
+{
+	this->timers.Cancel(id);
+}
+
+void MainThreadDispatcher::drainQueue()
+{
+	this->timers.CollectDue(this->runningCallbacks);
+
+	//collect everything posted so far before running any of it, so callbacks are free to post
+	//follow-up work that runs next frame
+	Callback callback;
+	while (this->completions.TryDequeue(callback)) {
+		this->runningCallbacks.push_back(std::move(callback));
+	}
+
+	if (this->hasOverflow) {
+		std::lock_guard<std::mutex> lock(this->overflowMutex);
+		this->runningCallbacks.insert(this->runningCallbacks.end(),
+			std::make_move_iterator(this->overflowCallbacks.begin()), std::make_move_iterator(this->overflowCallbacks.end()));
+		this->overflowCallbacks.clear();
+		this->hasOverflow = false;
+	}
+
+	for (Callback& callback : this->runningCallbacks) {
+		callback();
+	}
+	this->runningCallbacks.clear();
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "TimerQueue.h"
+#include "MPMCQueue.h"
+
+/// <summary>
+/// Queue of callbacks that must run on the main (frame loop) thread, e.g. completions of pool tasks that touch
+/// GameObjectManager or create GL resources. Any thread may post; the frame loop calls drainQueue once per frame.
+/// Posting goes through a lock-free ring so a finishing worker never waits on the frame loop; the mutex-guarded
+/// overflow list is only touched if the ring is full.
+/// postDelayed/postPeriodic callbacks become due on the first drain after their deadline, so staggering work
+/// over time never sleeps on any thread.
+/// </summary>
+class MainThreadDispatcher
+{
+public:
+	typedef std::function<void()> Callback;
+
+	static MainThreadDispatcher* getInstance();
+	void post(Callback callback);
+	TimerQueue::TimerID postDelayed(Callback callback, int delayMs);
+	TimerQueue::TimerID postPeriodic(Callback callback, int periodMs);
+	void cancelTimer(TimerQueue::TimerID id);
+	void drainQueue();
+
+private:
+	MainThreadDispatcher() : completions(QUEUE_CAPACITY) {};
+	MainThreadDispatcher(MainThreadDispatcher const&) : completions(QUEUE_CAPACITY) {};             // copy constructor is private
+	MainThreadDispatcher& operator=(MainThreadDispatcher const&) { return *this; };  // assignment operator is private
+	static MainThreadDispatcher* sharedInstance;
+
+	static const int QUEUE_CAPACITY = 4096;
+
+	TimerQueue timers;
+	MPMCQueue<Callback> completions;
+	std::atomic<bool> hasOverflow = false;
+	std::mutex overflowMutex;
+	std::vector<Callback> overflowCallbacks;
+	std::vector<Callback> runningCallbacks;
+};
@@ -0,0 +1,111 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() {}
+
+MappedFile::~MappedFile()
+{
+	this->close();
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const std::string& path)
+{
+	this->close();
+
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL) {
+		CloseHandle(file);
+		return false;
+	}
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == NULL) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	this->fileHandle = file;
+	this->mappingHandle = mapping;
+	this->data = static_cast<const char*>(view);
+	this->size = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (this->data != nullptr) UnmapViewOfFile(this->data);
+	if (this->mappingHandle != nullptr) CloseHandle(this->mappingHandle);
+	if (this->fileHandle != nullptr) CloseHandle(this->fileHandle);
+
+	this->data = nullptr;
+	this->size = 0;
+	this->fileHandle = nullptr;
+	this->mappingHandle = nullptr;
+}
+#else
+bool MappedFile::open(const std::string& path)
+{
+	this->close();
+
+	int file = ::open(path.c_str(), O_RDONLY);
+	if (file < 0) return false;
+
+	struct stat info;
+	if (fstat(file, &info) != 0 || info.st_size == 0) {
+		::close(file);
+		return false;
+	}
+
+	void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	::close(file); //the mapping keeps its own reference to the file
+	if (view == MAP_FAILED) return false;
+
+	this->data = static_cast<const char*>(view);
+	this->size = static_cast<size_t>(info.st_size);
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (this->data != nullptr) munmap(const_cast<char*>(this->data), this->size);
+
+	this->data = nullptr;
+	this->size = 0;
+}
+#endif
+
+bool MappedFile::isOpen() const
+{
+	return this->data != nullptr;
+}
+
+const char* MappedFile::getData() const
+{
+	return this->data;
+}
+
+size_t MappedFile::getSize() const
+{
+	return this->size;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+/// <summary>
+/// Read-only memory mapping of a whole file (MapViewOfFile on Windows, mmap elsewhere). The bytes stay valid
+/// until close or destruction, and pages are only read from disk when first touched.
+/// </summary>
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool open(const std::string& path);
+	void close();
+	bool isOpen() const;
+	const char* getData() const;
+	size_t getSize() const;
+
+private:
+	MappedFile(MappedFile const&) {};             // copy constructor is private
+	MappedFile& operator=(MappedFile const&) { return *this; };  // assignment operator is private
+
+	const char* data = nullptr;
+	size_t size = 0;
+
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+};
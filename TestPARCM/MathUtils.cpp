@@ -1 +1,309 @@
 #include "MathUtils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#if MATHUTILS_X86 && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+std::atomic<int> MathUtils::activeLevel = -1;
+
+uint64_t MathUtils::hashFNV1a(const void* data, size_t size, uint64_t seed)
+{
+	const uint64_t FNV_PRIME = 1099511628211ull;
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+	uint64_t hash = seed;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+MathUtils::SimdLevel MathUtils::getSupportedSimdLevel()
+{
+	static const SimdLevel supported = []() {
+#if MATHUTILS_X86 && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		int maxLeaf = info[0];
+		__cpuid(info, 1);
+		bool sse2 = (info[3] & (1 << 26)) != 0;
+		//AVX state has to be enabled by the OS too, not just present in the CPU
+		bool osAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+		bool avx2 = false;
+		if (osAvx && maxLeaf >= 7) {
+			__cpuidex(info, 7, 0);
+			avx2 = (info[1] & (1 << 5)) != 0;
+		}
+#elif MATHUTILS_X86
+		__builtin_cpu_init();
+		bool sse2 = __builtin_cpu_supports("sse2");
+		bool avx2 = __builtin_cpu_supports("avx2");
+#else
+		bool sse2 = false;
+		bool avx2 = false;
+#endif
+		if (avx2) return SIMD_AVX2;
+		if (sse2) return SIMD_SSE2;
+		return SIMD_SCALAR;
+	}();
+	return supported;
+}
+
+MathUtils::SimdLevel MathUtils::getSimdLevel()
+{
+	int level = activeLevel.load(std::memory_order_relaxed);
+	if (level < 0) {
+		level = getSupportedSimdLevel();
+		activeLevel.store(level, std::memory_order_relaxed);
+	}
+	return static_cast<SimdLevel>(level);
+}
+
+void MathUtils::setSimdLevel(SimdLevel level)
+{
+	activeLevel.store(std::min(level, getSupportedSimdLevel()), std::memory_order_relaxed);
+}
+
+const MathUtils::Kernels& MathUtils::getKernels()
+{
+	static const Kernels table[] = {
+		{ premultiplyScalar, swizzleScalar, premultiplyWideScalar, resampleRowScalar, resampleColumnScalar },
+#if MATHUTILS_X86
+		{ premultiplySSE2, swizzleSSE2, premultiplyWideSSE2, resampleRowSSE2, resampleColumnSSE2 },
+		//the row pass gathers a handful of pixels per output, wider registers do not help it
+		{ premultiplyAVX2, swizzleAVX2, premultiplyWideAVX2, resampleRowSSE2, resampleColumnAVX2 },
+#endif
+	};
+	return table[getSimdLevel()];
+}
+
+void MathUtils::resampleRGBA(const uint8_t* src, unsigned int srcWidth, unsigned int srcHeight,
+	uint8_t* dst, unsigned int dstWidth, unsigned int dstHeight, ResampleFilter filter)
+{
+	if (srcWidth == 0 || srcHeight == 0 || dstWidth == 0 || dstHeight == 0) return;
+	const Kernels& kernels = getKernels();
+
+	std::vector<uint16_t> premultiplied(static_cast<size_t>(srcWidth) * srcHeight * 4);
+	kernels.premultiplyWide(src, premultiplied.data(), static_cast<size_t>(srcWidth) * srcHeight);
+
+	ResampleWeights columns;
+	ResampleWeights rows;
+	computeWeights(srcWidth, dstWidth, filter, columns);
+	computeWeights(srcHeight, dstHeight, filter, rows);
+
+	//horizontal pass first, so the vertical pass reads dstWidth wide rows
+	size_t rowValues = static_cast<size_t>(dstWidth) * 4;
+	std::vector<uint16_t> narrowed(rowValues * srcHeight);
+	for (unsigned int y = 0; y < srcHeight; y++) {
+		kernels.resampleRow(premultiplied.data() + static_cast<size_t>(y) * srcWidth * 4, narrowed.data() + y * rowValues, dstWidth, columns);
+	}
+
+	std::vector<const uint16_t*> taps;
+	std::vector<uint16_t> resampled(rowValues);
+	for (unsigned int y = 0; y < dstHeight; y++) {
+		taps.clear();
+		for (int k = 0; k < rows.count[y]; k++) {
+			taps.push_back(narrowed.data() + (rows.first[y] + k) * rowValues);
+		}
+		kernels.resampleColumn(taps.data(), rows.weights.data() + rows.offset[y], rows.count[y], resampled.data(), rowValues);
+		unpremultiplyWide(resampled.data(), dst + y * rowValues, dstWidth);
+	}
+}
+
+void MathUtils::premultiplyAlpha(uint8_t* pixels, size_t count)
+{
+	getKernels().premultiply(pixels, count);
+}
+
+void MathUtils::unpremultiplyAlpha(uint8_t* pixels, size_t count)
+{
+	//16.16 reciprocals of every alpha, a division per channel costs more than the rest of the loop
+	static const std::vector<uint32_t> reciprocal = []() {
+		std::vector<uint32_t> table(256, 0);
+		for (uint32_t a = 1; a < 256; a++) {
+			table[a] = ((255u << 16) + a / 2) / a;
+		}
+		return table;
+	}();
+
+	for (size_t i = 0; i < count; i++) {
+		uint8_t* pixel = pixels + i * 4;
+		uint32_t alpha = pixel[3];
+		if (alpha == 255) continue;
+		for (int c = 0; c < 3; c++) {
+			uint32_t value = (pixel[c] * reciprocal[alpha] + (1u << 15)) >> 16;
+			pixel[c] = static_cast<uint8_t>(std::min(value, 255u));
+		}
+	}
+}
+
+void MathUtils::swizzleRGBA(const uint8_t* src, uint8_t* dst, size_t count, SwizzleOrder order)
+{
+	getKernels().swizzle(src, dst, count, order);
+}
+
+namespace {
+	double filterSupport(MathUtils::ResampleFilter filter)
+	{
+		switch (filter) {
+		case MathUtils::FILTER_BILINEAR: return 1.0;
+		case MathUtils::FILTER_LANCZOS: return 3.0;
+		default: return 0.5;
+		}
+	}
+
+	double sinc(double x)
+	{
+		if (x == 0.0) return 1.0;
+		x *= 3.14159265358979323846;
+		return std::sin(x) / x;
+	}
+
+	double filterValue(MathUtils::ResampleFilter filter, double x)
+	{
+		switch (filter) {
+		case MathUtils::FILTER_BILINEAR:
+			x = std::fabs(x);
+			return x < 1.0 ? 1.0 - x : 0.0;
+		case MathUtils::FILTER_LANCZOS:
+			return (x > -3.0 && x < 3.0) ? sinc(x) * sinc(x / 3.0) : 0.0;
+		default:
+			return (x > -0.5 && x <= 0.5) ? 1.0 : 0.0;
+		}
+	}
+}
+
+void MathUtils::computeWeights(unsigned int srcSize, unsigned int dstSize, ResampleFilter filter, ResampleWeights& out)
+{
+	out = ResampleWeights();
+	double scale = static_cast<double>(srcSize) / dstSize;
+	double filterScale = std::max(scale, 1.0); //when shrinking the filter widens to cover every source pixel
+	double support = filterSupport(filter) * filterScale;
+
+	std::vector<double> values;
+	for (unsigned int x = 0; x < dstSize; x++) {
+		double center = (x + 0.5) * scale;
+		int first = std::max(0, static_cast<int>(std::floor(center - support + 0.5)));
+		int last = std::min(static_cast<int>(srcSize), static_cast<int>(std::floor(center + support + 0.5)));
+		if (last <= first) {
+			first = std::min(static_cast<int>(center), static_cast<int>(srcSize) - 1);
+			last = first + 1;
+		}
+
+		values.clear();
+		double total = 0.0;
+		for (int i = first; i < last; i++) {
+			double value = filterValue(filter, (i - center + 0.5) / filterScale);
+			values.push_back(value);
+			total += value;
+		}
+
+		//fixed point, with the rounding error folded into the largest tap so every row sums to exactly one
+		const int one = 1 << WEIGHT_BITS;
+		int sum = 0;
+		size_t largest = 0;
+		out.offset.push_back(static_cast<int>(out.weights.size()));
+		for (size_t k = 0; k < values.size(); k++) {
+			double normalized = total != 0.0 ? values[k] / total : (k == 0 ? 1.0 : 0.0);
+			int16_t weight = static_cast<int16_t>(std::lround(normalized * one));
+			out.weights.push_back(weight);
+			sum += weight;
+			if (weight > out.weights[out.offset.back() + largest]) largest = k;
+		}
+		out.weights[out.offset.back() + largest] += static_cast<int16_t>(one - sum);
+
+		out.first.push_back(first);
+		out.count.push_back(last - first);
+	}
+}
+
+void MathUtils::premultiplyScalar(uint8_t* pixels, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		uint8_t* pixel = pixels + i * 4;
+		uint32_t alpha = pixel[3];
+		for (int c = 0; c < 3; c++) {
+			//exact round(c * a / 255)
+			uint32_t value = pixel[c] * alpha + 128;
+			pixel[c] = static_cast<uint8_t>((value + (value >> 8)) >> 8);
+		}
+	}
+}
+
+void MathUtils::swizzleScalar(const uint8_t* src, uint8_t* dst, size_t count, SwizzleOrder order)
+{
+	static const int sources[3][4] = { { 2, 1, 0, 3 }, { 3, 0, 1, 2 }, { 3, 2, 1, 0 } };
+	const int* from = sources[order];
+
+	for (size_t i = 0; i < count; i++) {
+		uint8_t pixel[4];
+		std::memcpy(pixel, src + i * 4, 4);
+		for (int c = 0; c < 4; c++) {
+			dst[i * 4 + c] = pixel[from[c]];
+		}
+	}
+}
+
+void MathUtils::premultiplyWideScalar(const uint8_t* src, uint16_t* dst, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		uint32_t alpha = src[i * 4 + 3];
+		for (int c = 0; c < 3; c++) {
+			dst[i * 4 + c] = static_cast<uint16_t>((src[i * 4 + c] * alpha + 1) >> 1);
+		}
+		dst[i * 4 + 3] = static_cast<uint16_t>((255 * alpha + 1) >> 1);
+	}
+}
+
+void MathUtils::unpremultiplyWide(const uint16_t* src, uint8_t* dst, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		const uint16_t* pixel = src + i * 4;
+		uint32_t alpha = pixel[3];
+		if (alpha == 0) {
+			std::memset(dst + i * 4, 0, 4);
+			continue;
+		}
+
+		//colour is divided by the wide alpha, not the rounded 8-bit one. ringing can push colour above
+		//alpha, that only ever clamps to 255, so clamp first and keep the product inside 32 bits
+		uint32_t reciprocal = ((255u << 16) + alpha / 2) / alpha;
+		for (int c = 0; c < 3; c++) {
+			uint32_t value = std::min<uint32_t>(pixel[c], alpha);
+			dst[i * 4 + c] = static_cast<uint8_t>(std::min((value * reciprocal + (1u << 15)) >> 16, 255u));
+		}
+		dst[i * 4 + 3] = static_cast<uint8_t>(std::min((alpha * 2 + 127) / 255, 255u));
+	}
+}
+
+void MathUtils::resampleRowScalar(const uint16_t* src, uint16_t* dst, unsigned int dstWidth, const ResampleWeights& weights)
+{
+	for (unsigned int x = 0; x < dstWidth; x++) {
+		const uint16_t* pixel = src + weights.first[x] * 4;
+		const int16_t* weight = weights.weights.data() + weights.offset[x];
+
+		int32_t sums[4] = { 1 << (WEIGHT_BITS - 1), 1 << (WEIGHT_BITS - 1), 1 << (WEIGHT_BITS - 1), 1 << (WEIGHT_BITS - 1) };
+		for (int k = 0; k < weights.count[x]; k++) {
+			for (int c = 0; c < 4; c++) {
+				sums[c] += pixel[k * 4 + c] * weight[k];
+			}
+		}
+		for (int c = 0; c < 4; c++) {
+			dst[x * 4 + c] = static_cast<uint16_t>(std::clamp(sums[c] >> WEIGHT_BITS, 0, WIDE_MAX));
+		}
+	}
+}
+
+void MathUtils::resampleColumnScalar(const uint16_t* const* rows, const int16_t* weights, int taps, uint16_t* dst, size_t values)
+{
+	for (size_t i = 0; i < values; i++) {
+		int32_t sum = 1 << (WEIGHT_BITS - 1);
+		for (int k = 0; k < taps; k++) {
+			sum += rows[k][i] * weights[k];
+		}
+		dst[i] = static_cast<uint16_t>(std::clamp(sum >> WEIGHT_BITS, 0, WIDE_MAX));
+	}
+}
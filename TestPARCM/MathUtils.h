@@ -1,5 +1,87 @@
 #pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MATHUTILS_X86 1
+#else
+#define MATHUTILS_X86 0
+#endif
+
+/// <summary>
+/// Hashing and the pixel kernels used on every image load. Image kernels work on tightly packed 8-bit RGBA and
+/// come in a scalar, an SSE2 and an AVX2 flavour; the widest one the CPU supports is picked at first use.
+/// Resampling is separable (a horizontal then a vertical pass with 14-bit fixed point weights) and runs on
+/// premultiplied colour, so transparent pixels never bleed into their neighbours. The premultiplied
+/// intermediate keeps 15 bits per channel; at 8 bits a pixel with alpha 3 would be left with 4 colour levels.
+/// </summary>
 class MathUtils
 {
-};
+public:
+	static const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+
+	//64-bit FNV-1a. pass the previous result as seed to hash several buffers as one
+	static uint64_t hashFNV1a(const void* data, size_t size, uint64_t seed = FNV_OFFSET_BASIS);
+
+	enum SimdLevel { SIMD_SCALAR = 0, SIMD_SSE2 = 1, SIMD_AVX2 = 2 };
+	enum ResampleFilter { FILTER_BOX = 0, FILTER_BILINEAR = 1, FILTER_LANCZOS = 2 };
+	enum SwizzleOrder { SWIZZLE_BGRA = 0, SWIZZLE_ARGB = 1, SWIZZLE_ABGR = 2 }; //destination byte order, source is RGBA
+
+	static SimdLevel getSupportedSimdLevel(); //what the CPU and OS support
+	static SimdLevel getSimdLevel();
+	static void setSimdLevel(SimdLevel level); //clamped to the supported level, meant for benchmarks
+
+	//resizes src into dst. meant for shrinking; enlarging works but box is then a nearest neighbour
+	static void resampleRGBA(const uint8_t* src, unsigned int srcWidth, unsigned int srcHeight,
+		uint8_t* dst, unsigned int dstWidth, unsigned int dstHeight, ResampleFilter filter = FILTER_BOX);
+
+	static void premultiplyAlpha(uint8_t* pixels, size_t count);
+	static void unpremultiplyAlpha(uint8_t* pixels, size_t count);
+	static void swizzleRGBA(const uint8_t* src, uint8_t* dst, size_t count, SwizzleOrder order); //src may equal dst
 
+private:
+	//per output pixel or row: first source index, number of taps, and an offset into the weight table
+	struct ResampleWeights {
+		std::vector<int> first;
+		std::vector<int> count;
+		std::vector<int> offset;
+		std::vector<int16_t> weights;
+	};
+
+	static const int WEIGHT_BITS = 14;
+	static constexpr int WIDE_MAX = 32767; //wide channels stay signed 16-bit so they can go through _mm_madd_epi16
+
+	static void computeWeights(unsigned int srcSize, unsigned int dstSize, ResampleFilter filter, ResampleWeights& out);
+
+	//the resampler's premultiplied pixels: colour (c * a + 1) >> 1 and alpha (255 * a + 1) >> 1, 16 bits apiece
+	struct Kernels {
+		void (*premultiply)(uint8_t* pixels, size_t count);
+		void (*swizzle)(const uint8_t* src, uint8_t* dst, size_t count, SwizzleOrder order);
+		void (*premultiplyWide)(const uint8_t* src, uint16_t* dst, size_t count);
+		void (*resampleRow)(const uint16_t* src, uint16_t* dst, unsigned int dstWidth, const ResampleWeights& weights);
+		void (*resampleColumn)(const uint16_t* const* rows, const int16_t* weights, int taps, uint16_t* dst, size_t values);
+	};
+	static const Kernels& getKernels();
+
+	static void premultiplyScalar(uint8_t* pixels, size_t count);
+	static void swizzleScalar(const uint8_t* src, uint8_t* dst, size_t count, SwizzleOrder order);
+	static void premultiplyWideScalar(const uint8_t* src, uint16_t* dst, size_t count);
+	static void unpremultiplyWide(const uint16_t* src, uint8_t* dst, size_t count); //output sized, scalar is enough
+	static void resampleRowScalar(const uint16_t* src, uint16_t* dst, unsigned int dstWidth, const ResampleWeights& weights);
+	static void resampleColumnScalar(const uint16_t* const* rows, const int16_t* weights, int taps, uint16_t* dst, size_t values);
+
+	//MathUtilsSIMD.cpp, only called once the CPU was checked for support
+	static void premultiplySSE2(uint8_t* pixels, size_t count);
+	static void swizzleSSE2(const uint8_t* src, uint8_t* dst, size_t count, SwizzleOrder order);
+	static void premultiplyWideSSE2(const uint8_t* src, uint16_t* dst, size_t count);
+	static void resampleRowSSE2(const uint16_t* src, uint16_t* dst, unsigned int dstWidth, const ResampleWeights& weights);
+	static void resampleColumnSSE2(const uint16_t* const* rows, const int16_t* weights, int taps, uint16_t* dst, size_t values);
+	static void premultiplyAVX2(uint8_t* pixels, size_t count);
+	static void swizzleAVX2(const uint8_t* src, uint8_t* dst, size_t count, SwizzleOrder order);
+	static void premultiplyWideAVX2(const uint8_t* src, uint16_t* dst, size_t count);
+	static void resampleColumnAVX2(const uint16_t* const* rows, const int16_t* weights, int taps, uint16_t* dst, size_t values);
+
+	static std::atomic<int> activeLevel; //-1 until first use
+};
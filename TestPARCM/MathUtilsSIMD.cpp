@@ -0,0 +1,281 @@
+#include "MathUtils.h"
+
+#if MATHUTILS_X86
+#include <algorithm>
+#include <cstring>
+#include <immintrin.h>
+
+//msvc compiles any intrinsic without /arch flags, gcc and clang need the target spelled out per function
+#if defined(_MSC_VER)
+#define TARGET_SSE2
+#define TARGET_AVX2
+#else
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace {
+	const int WEIGHT_BITS = 14;
+	const int WIDE_MAX = 32767;
+
+	//two 16-bit weights side by side, the layout _mm_madd_epi16 pairs with interleaved samples
+	int32_t weightPair(int16_t first, int16_t second)
+	{
+		return static_cast<int32_t>(static_cast<uint16_t>(first) | (static_cast<uint32_t>(static_cast<uint16_t>(second)) << 16));
+	}
+
+	void resampleColumnTail(const uint16_t* const* rows, const int16_t* weights, int taps, uint16_t* dst, size_t start, size_t values)
+	{
+		for (size_t i = start; i < values; i++) {
+			int32_t sum = 1 << (WEIGHT_BITS - 1);
+			for (int k = 0; k < taps; k++) {
+				sum += rows[k][i] * weights[k];
+			}
+			dst[i] = static_cast<uint16_t>(std::clamp(sum >> WEIGHT_BITS, 0, WIDE_MAX));
+		}
+	}
+
+	//round(c * a / 255) on 16-bit lanes holding r, g, b, a of two (SSE2) or four (AVX2) pixels
+	TARGET_SSE2 __m128i premultiplyLanes(__m128i lanes)
+	{
+		__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lanes, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		__m128i value = _mm_add_epi16(_mm_mullo_epi16(lanes, alpha), _mm_set1_epi16(128));
+		return _mm_srli_epi16(_mm_add_epi16(value, _mm_srli_epi16(value, 8)), 8);
+	}
+
+	TARGET_AVX2 __m256i premultiplyLanes(__m256i lanes)
+	{
+		__m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(lanes, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		__m256i value = _mm256_add_epi16(_mm256_mullo_epi16(lanes, alpha), _mm256_set1_epi16(128));
+		return _mm256_srli_epi16(_mm256_add_epi16(value, _mm256_srli_epi16(value, 8)), 8);
+	}
+
+	//(c * a + 1) >> 1 for colour and (255 * a + 1) >> 1 for alpha, on 16-bit lanes of two or four pixels.
+	//products stay below 65536, so the low half of an unsigned multiply is the whole product
+	TARGET_SSE2 __m128i premultiplyWideLanes(__m128i lanes)
+	{
+		const __m128i alphaLanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+		__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lanes, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		__m128i factor = _mm_or_si128(_mm_andnot_si128(alphaLanes, alpha), _mm_and_si128(alphaLanes, _mm_set1_epi16(255)));
+		return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(lanes, factor), _mm_set1_epi16(1)), 1);
+	}
+
+	TARGET_AVX2 __m256i premultiplyWideLanes(__m256i lanes)
+	{
+		const __m256i alphaLanes = _mm256_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0);
+		__m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(lanes, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		__m256i factor = _mm256_or_si256(_mm256_andnot_si256(alphaLanes, alpha), _mm256_and_si256(alphaLanes, _mm256_set1_epi16(255)));
+		return _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(lanes, factor), _mm256_set1_epi16(1)), 1);
+	}
+
+	//sums back to 16-bit wide values, clamped to [0, WIDE_MAX] like the scalar code
+	TARGET_SSE2 __m128i narrowSums(__m128i low, __m128i high)
+	{
+		__m128i packed = _mm_packs_epi32(_mm_srai_epi32(low, WEIGHT_BITS), _mm_srai_epi32(high, WEIGHT_BITS));
+		return _mm_max_epi16(packed, _mm_setzero_si128());
+	}
+
+	TARGET_AVX2 __m256i narrowSums(__m256i low, __m256i high)
+	{
+		__m256i packed = _mm256_packs_epi32(_mm256_srai_epi32(low, WEIGHT_BITS), _mm256_srai_epi32(high, WEIGHT_BITS));
+		return _mm256_max_epi16(packed, _mm256_setzero_si256());
+	}
+
+	TARGET_SSE2 __m128i swizzleLanes(__m128i pixels, MathUtils::SwizzleOrder order)
+	{
+		switch (order) {
+		case MathUtils::SWIZZLE_BGRA: {
+			__m128i keep = _mm_and_si128(pixels, _mm_set1_epi32(static_cast<int>(0xFF00FF00)));
+			__m128i red = _mm_srli_epi32(_mm_slli_epi32(pixels, 24), 8);
+			__m128i blue = _mm_srli_epi32(_mm_slli_epi32(pixels, 8), 24);
+			return _mm_or_si128(keep, _mm_or_si128(red, blue));
+		}
+		case MathUtils::SWIZZLE_ARGB:
+			return _mm_or_si128(_mm_slli_epi32(pixels, 8), _mm_srli_epi32(pixels, 24));
+		default: {
+			//full byte reverse: swap the 16-bit halves, then the bytes inside them
+			__m128i halves = _mm_or_si128(_mm_slli_epi32(pixels, 16), _mm_srli_epi32(pixels, 16));
+			return _mm_or_si128(_mm_slli_epi16(halves, 8), _mm_srli_epi16(halves, 8));
+		}
+		}
+	}
+}
+
+TARGET_SSE2 void MathUtils::premultiplySSE2(uint8_t* pixels, size_t count)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i * 4));
+		__m128i low = premultiplyLanes(_mm_unpacklo_epi8(source, zero));
+		__m128i high = premultiplyLanes(_mm_unpackhi_epi8(source, zero));
+		//alpha itself went through the multiply too, put the original back
+		__m128i result = _mm_or_si128(_mm_andnot_si128(alphaMask, _mm_packus_epi16(low, high)), _mm_and_si128(source, alphaMask));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i * 4), result);
+	}
+	premultiplyScalar(pixels + i * 4, count - i);
+}
+
+TARGET_AVX2 void MathUtils::premultiplyAVX2(uint8_t* pixels, size_t count)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+
+	//unpack and pack both work within 128-bit lanes, so pixel order comes back unchanged
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i source = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels + i * 4));
+		__m256i low = premultiplyLanes(_mm256_unpacklo_epi8(source, zero));
+		__m256i high = premultiplyLanes(_mm256_unpackhi_epi8(source, zero));
+		__m256i result = _mm256_or_si256(_mm256_andnot_si256(alphaMask, _mm256_packus_epi16(low, high)), _mm256_and_si256(source, alphaMask));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels + i * 4), result);
+	}
+	premultiplyScalar(pixels + i * 4, count - i);
+}
+
+TARGET_SSE2 void MathUtils::swizzleSSE2(const uint8_t* src, uint8_t* dst, size_t count, SwizzleOrder order)
+{
+	//SSE2 has no byte shuffle, each order is a fixed set of shifts and masks on 32-bit pixels
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), swizzleLanes(pixels, order));
+	}
+	swizzleScalar(src + i * 4, dst + i * 4, count - i, order);
+}
+
+TARGET_AVX2 void MathUtils::swizzleAVX2(const uint8_t* src, uint8_t* dst, size_t count, SwizzleOrder order)
+{
+	static const int sources[3][4] = { { 2, 1, 0, 3 }, { 3, 0, 1, 2 }, { 3, 2, 1, 0 } };
+
+	alignas(32) int8_t mask[32];
+	for (int b = 0; b < 32; b++) {
+		mask[b] = static_cast<int8_t>((b % 16) / 4 * 4 + sources[order][b % 4]);
+	}
+	const __m256i shuffle = _mm256_load_si256(reinterpret_cast<const __m256i*>(mask));
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_shuffle_epi8(pixels, shuffle));
+	}
+	swizzleScalar(src + i * 4, dst + i * 4, count - i, order);
+}
+
+TARGET_SSE2 void MathUtils::premultiplyWideSSE2(const uint8_t* src, uint16_t* dst, size_t count)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), premultiplyWideLanes(_mm_unpacklo_epi8(source, zero)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4 + 8), premultiplyWideLanes(_mm_unpackhi_epi8(source, zero)));
+	}
+	premultiplyWideScalar(src + i * 4, dst + i * 4, count - i);
+}
+
+TARGET_AVX2 void MathUtils::premultiplyWideAVX2(const uint8_t* src, uint16_t* dst, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		//widening straight from memory keeps the pixels in order, unpack would interleave the 128-bit lanes
+		__m256i low = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4)));
+		__m256i high = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4 + 16)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), premultiplyWideLanes(low));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4 + 16), premultiplyWideLanes(high));
+	}
+	premultiplyWideScalar(src + i * 4, dst + i * 4, count - i);
+}
+
+TARGET_SSE2 void MathUtils::resampleRowSSE2(const uint16_t* src, uint16_t* dst, unsigned int dstWidth, const ResampleWeights& weights)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	for (unsigned int x = 0; x < dstWidth; x++) {
+		const uint16_t* pixel = src + weights.first[x] * 4;
+		const int16_t* weight = weights.weights.data() + weights.offset[x];
+		int taps = weights.count[x];
+
+		//one 32-bit sum per channel. two neighbouring pixels are interleaved per channel (r0 r1 g0 g1 ...)
+		//so a single madd applies both of their weights
+		__m128i sum = _mm_set1_epi32(1 << (WEIGHT_BITS - 1));
+		int k = 0;
+		for (; k + 2 <= taps; k += 2) {
+			__m128i two = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixel + k * 4));
+			__m128i interleaved = _mm_unpacklo_epi16(two, _mm_srli_si128(two, 8));
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(interleaved, _mm_set1_epi32(weightPair(weight[k], weight[k + 1]))));
+		}
+		if (k < taps) {
+			__m128i one = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pixel + k * 4)), zero);
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(one, _mm_set1_epi32(weightPair(weight[k], 0))));
+		}
+
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x * 4), narrowSums(sum, sum));
+	}
+}
+
+TARGET_SSE2 void MathUtils::resampleColumnSSE2(const uint16_t* const* rows, const int16_t* weights, int taps, uint16_t* dst, size_t values)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rounding = _mm_set1_epi32(1 << (WEIGHT_BITS - 1));
+
+	//16 values at a time, two source rows interleaved per madd, four accumulators of four values each
+	size_t i = 0;
+	for (; i + 16 <= values; i += 16) {
+		__m128i sum0 = rounding, sum1 = rounding, sum2 = rounding, sum3 = rounding;
+
+		for (int k = 0; k < taps; k += 2) {
+			const uint16_t* second = k + 1 < taps ? rows[k + 1] + i : nullptr;
+			__m128i firstLow = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k] + i));
+			__m128i firstHigh = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k] + i + 8));
+			__m128i secondLow = second != nullptr ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(second)) : zero;
+			__m128i secondHigh = second != nullptr ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(second + 8)) : zero;
+			__m128i weight = _mm_set1_epi32(weightPair(weights[k], second != nullptr ? weights[k + 1] : 0));
+
+			sum0 = _mm_add_epi32(sum0, _mm_madd_epi16(_mm_unpacklo_epi16(firstLow, secondLow), weight));
+			sum1 = _mm_add_epi32(sum1, _mm_madd_epi16(_mm_unpackhi_epi16(firstLow, secondLow), weight));
+			sum2 = _mm_add_epi32(sum2, _mm_madd_epi16(_mm_unpacklo_epi16(firstHigh, secondHigh), weight));
+			sum3 = _mm_add_epi32(sum3, _mm_madd_epi16(_mm_unpackhi_epi16(firstHigh, secondHigh), weight));
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), narrowSums(sum0, sum1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), narrowSums(sum2, sum3));
+	}
+	resampleColumnTail(rows, weights, taps, dst, i, values);
+}
+
+TARGET_AVX2 void MathUtils::resampleColumnAVX2(const uint16_t* const* rows, const int16_t* weights, int taps, uint16_t* dst, size_t values)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i rounding = _mm256_set1_epi32(1 << (WEIGHT_BITS - 1));
+
+	//same scheme as SSE2 on 32 values. every step stays inside its 128-bit lane, so the final pack
+	//puts the values back in source order without a cross-lane permute
+	size_t i = 0;
+	for (; i + 32 <= values; i += 32) {
+		__m256i sum0 = rounding, sum1 = rounding, sum2 = rounding, sum3 = rounding;
+
+		for (int k = 0; k < taps; k += 2) {
+			const uint16_t* second = k + 1 < taps ? rows[k + 1] + i : nullptr;
+			__m256i firstLow = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[k] + i));
+			__m256i firstHigh = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[k] + i + 16));
+			__m256i secondLow = second != nullptr ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(second)) : zero;
+			__m256i secondHigh = second != nullptr ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(second + 16)) : zero;
+			__m256i weight = _mm256_set1_epi32(weightPair(weights[k], second != nullptr ? weights[k + 1] : 0));
+
+			sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(_mm256_unpacklo_epi16(firstLow, secondLow), weight));
+			sum1 = _mm256_add_epi32(sum1, _mm256_madd_epi16(_mm256_unpackhi_epi16(firstLow, secondLow), weight));
+			sum2 = _mm256_add_epi32(sum2, _mm256_madd_epi16(_mm256_unpacklo_epi16(firstHigh, secondHigh), weight));
+			sum3 = _mm256_add_epi32(sum3, _mm256_madd_epi16(_mm256_unpackhi_epi16(firstHigh, secondHigh), weight));
+		}
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), narrowSums(sum0, sum1));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 16), narrowSums(sum2, sum3));
+	}
+	resampleColumnTail(rows, weights, taps, dst, i, values);
+}
+
+#endif
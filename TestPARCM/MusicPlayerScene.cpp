@@ -1,4 +1,5 @@
 #include "MusicPlayerScene.h"
+#include "AssetPack.h"
 #include <algorithm>
 #include <chrono>
 #include <thread>
@@ -10,7 +11,8 @@ void MusicPlayerScene::loadParallaxLayers(const std::string& folderPath, int cou
 	for (int i = 0; i < count; ++i) {
 		std::string path = folderPath + "/" + std::to_string(i + 1) + ".png";
 		ParallaxLayer &layer = parallaxLayers[i];
-		if (!layer.texture.loadFromFile(path)) {
+		//layers are drawn at window height, a taller source is shrunk to it on load
+		if (!AssetPack::getInstance()->loadTexture(layer.texture, path, sf::Vector2u(0, window->getSize().y))) {
 			std::cerr << "MusicPlayerScene: failed to load parallax texture: " << path << '\n';
 			layer.valid = false;
 			continue;
@@ -74,7 +76,7 @@ MusicPlayerScene::MusicPlayerScene(sf::RenderWindow* window) : window(window) {
 	loadParallaxLayers("Media/Background/Clouds 7", 4);
 
 	const std::string fontPath = "Media/Sansation.ttf";
-	if (!font.loadFromFile(fontPath)) {
+	if (!AssetPack::getInstance()->loadFont(font, fontPath)) {
 		std::cerr << "MusicPlayerScene: failed to load font: " << fontPath << '\n';
 	}
 
@@ -96,23 +98,27 @@ MusicPlayerScene::MusicPlayerScene(sf::RenderWindow* window) : window(window) {
 	}
 
 	const std::string vinylPath = "Media/Textures/pngimg.com - vinyl_PNG18.png";
-	if (!vinylTexture.loadFromFile(vinylPath)) {
+	sf::Image vinylImage;
+	if (!AssetPack::getInstance()->loadImage(vinylImage, vinylPath)) {
 		std::cerr << "MusicPlayerScene: failed to load vinyl texture: " << vinylPath << '\n';
 	}
 	else {
-		vinylSprite.setTexture(vinylTexture);
+		//the record is drawn at vinylScale, so keep only the pixels that end up on screen
+		vinylSpriteScale = AssetPack::shrinkToScale(vinylImage, vinylScale);
+		vinylTexture.loadFromImage(vinylImage);
+		vinylSprite.setTexture(vinylTexture, true);
 		sf::FloatRect vb = vinylSprite.getLocalBounds();
 		vinylSprite.setOrigin(vb.left + vb.width / 2.0f, vb.top + vb.height / 2.0f);
-		vinylSprite.setScale(vinylScale, vinylScale);
-		vinylRadius = (std::max(vb.width, vb.height) * vinylScale) / 2.0f;
+		vinylSprite.setScale(vinylSpriteScale, vinylSpriteScale);
+		vinylRadius = (std::max(vb.width, vb.height) * vinylSpriteScale) / 2.0f;
 	}
+
+	loaderPool.StartScheduling();
 }
 
 MusicPlayerScene::~MusicPlayerScene() {
+	currentLoadToken.Cancel();
 	loadingInProgress = false;
-	if (loaderThread.joinable()) {
-		loaderThread.join();
-	}
 }
 
 void MusicPlayerScene::stopPlaybackIfPlaying() {
@@ -127,59 +133,72 @@ void MusicPlayerScene::beginBackgroundLoad(int albumIndex) {
 		return;
 	}
 
-	bool expected = false;
-	if (!loadingInProgress.compare_exchange_strong(expected, true)) {
-		return;
-	}
-
 	stopPlaybackIfPlaying();
 
-	loadingFinished = false;
-	resourcesFinalized = false;
-	pendingSoundBufferValid = false;
+	//supersede any load still in flight. it drops out at its next checkpoint and never publishes,
+	//so switching latency only depends on the newest request.
+	CancellationToken token;
+	{
+		std::lock_guard<std::mutex> lk(pendingMutex);
+		currentLoadToken.Cancel();
+		currentLoadToken = token;
 
-	loadingAlbumIndex = albumIndex;
+		pendingAlbumImage = sf::Image();
+		pendingAlbumSpriteScale = albumScale;
+		pendingSoundBuffer = sf::SoundBuffer();
+		pendingSoundBufferValid = false;
 
-	if (loaderThread.joinable()) {
-		loaderThread.join();
+		loadingFinished = false;
+		resourcesFinalized = false;
+		loadingInProgress = true;
+		loadingAlbumIndex = albumIndex;
 	}
 
 	Album albumToLoad = albums[albumIndex];
 
-	loaderThread = std::thread([this, albumToLoad]() {
+	loaderPool.ScheduleTask([this, albumToLoad, token]() {
 		sf::Image img;
-		if (!img.loadFromFile(albumToLoad.texturePath)) {
+		float spriteScale = albumScale;
+		if (!AssetPack::getInstance()->loadImage(img, albumToLoad.texturePath)) {
 			std::cerr << "MusicPlayerScene: background loader failed to load image: " << albumToLoad.texturePath << '\n';
 		}
+		else {
+			//shrink here on the loader rather than uploading the full cover and minifying it every frame
+			spriteScale = AssetPack::shrinkToScale(img, albumScale);
+		}
 		{
 			std::lock_guard<std::mutex> lk(pendingMutex);
+			if (token.IsCancelled()) return;
 			pendingAlbumImage = std::move(img);
+			pendingAlbumSpriteScale = spriteScale;
 		}
 
 
-		if (assetLoadDelayMs > 0) {
-			std::this_thread::sleep_for(std::chrono::milliseconds(assetLoadDelayMs));
+		if (assetLoadDelayMs > 0 && !token.SleepFor(assetLoadDelayMs)) {
+			return;
 		}
 
 		sf::SoundBuffer buf;
 		if (!buf.loadFromFile(albumToLoad.soundPath)) {
 			std::cerr << "MusicPlayerScene: background loader failed to decode sound: " << albumToLoad.soundPath << '\n';
-			pendingSoundBufferValid = false;
 		}
 		else {
 			std::lock_guard<std::mutex> lk(pendingMutex);
+			if (token.IsCancelled()) return;
 			pendingSoundBuffer = std::move(buf);
 			pendingSoundBufferValid = true;
 		}
 
 
-		if (assetLoadDelayMs > 0) {
-			std::this_thread::sleep_for(std::chrono::milliseconds(assetLoadDelayMs));
+		if (assetLoadDelayMs > 0 && !token.SleepFor(assetLoadDelayMs)) {
+			return;
 		}
 
+		std::lock_guard<std::mutex> lk(pendingMutex);
+		if (token.IsCancelled()) return;
 		loadingFinished = true;
 		loadingInProgress = false;
-		});
+		}, PRIORITY_HIGH);
 }
 
 bool MusicPlayerScene::isReadyToFinalize() const {
@@ -196,6 +215,7 @@ void MusicPlayerScene::finalizeLoadedResources() {
 		std::lock_guard<std::mutex> lk(pendingMutex);
 		img = std::move(pendingAlbumImage);
 		pendingAlbumImage = sf::Image(); 
+		albumSpriteScale = pendingAlbumSpriteScale;
 	}
 
 	if (img.getSize().x > 0 && img.getSize().y > 0) {
@@ -203,25 +223,28 @@ void MusicPlayerScene::finalizeLoadedResources() {
 			std::cerr << "MusicPlayerScene: finalize failed to create texture from image\n";
 		}
 		else {
-			albumSprite.setTexture(albumTexture);
+			albumSprite.setTexture(albumTexture, true);
 			sf::FloatRect b = albumSprite.getLocalBounds();
 			albumSprite.setOrigin(b.left + b.width / 2.0f, b.top + b.height / 2.0f);
-			albumSprite.setScale(albumScale, albumScale);
-			albumRadius = (std::max(b.width, b.height) * albumScale) / 2.0f;
+			albumSprite.setScale(albumSpriteScale, albumSpriteScale);
+			albumRadius = (std::max(b.width, b.height) * albumSpriteScale) / 2.0f;
 		}
 	}
 	else {
 		int idx = loadingAlbumIndex.load();
 		const std::string fallbackTex = (idx >= 0 && idx < static_cast<int>(albums.size())) ? albums[idx].texturePath : std::string();
-		if (!fallbackTex.empty() && !albumTexture.loadFromFile(fallbackTex)) {
+		sf::Image fallbackImg;
+		if (!fallbackTex.empty() && !AssetPack::getInstance()->loadImage(fallbackImg, fallbackTex)) {
 			std::cerr << "MusicPlayerScene: fallback failed to load album texture: " << fallbackTex << '\n';
 		}
 		else if (!fallbackTex.empty()) {
-			albumSprite.setTexture(albumTexture);
+			albumSpriteScale = AssetPack::shrinkToScale(fallbackImg, albumScale);
+			albumTexture.loadFromImage(fallbackImg);
+			albumSprite.setTexture(albumTexture, true);
 			sf::FloatRect b = albumSprite.getLocalBounds();
 			albumSprite.setOrigin(b.left + b.width / 2.0f, b.top + b.height / 2.0f);
-			albumSprite.setScale(albumScale, albumScale);
-			albumRadius = (std::max(b.width, b.height) * albumScale) / 2.0f;
+			albumSprite.setScale(albumSpriteScale, albumSpriteScale);
+			albumRadius = (std::max(b.width, b.height) * albumSpriteScale) / 2.0f;
 		}
 	}
 
@@ -258,10 +281,6 @@ void MusicPlayerScene::finalizeLoadedResources() {
 	}
 
 	resourcesFinalized = true;
-
-	if (loaderThread.joinable()) {
-		loaderThread.join();
-	}
 }
 
 void MusicPlayerScene::start() {
@@ -281,8 +300,8 @@ void MusicPlayerScene::start() {
 
 	if (albumTexture.getSize().x > 0 && albumTexture.getSize().y > 0) {
 		sf::FloatRect b = albumSprite.getLocalBounds();
-		albumSprite.setScale(albumScale, albumScale);
-		albumRadius = (std::max(b.width, b.height) * albumScale) / 2.0f;
+		albumSprite.setScale(albumSpriteScale, albumSpriteScale);
+		albumRadius = (std::max(b.width, b.height) * albumSpriteScale) / 2.0f;
 	}
 
 	const float extraTextPadding = 50.0f;
@@ -293,7 +312,7 @@ void MusicPlayerScene::start() {
 
 	if (vinylTexture.getSize().x > 0 && vinylTexture.getSize().y > 0) {
 		vinylSprite.setPosition(center);
-		vinylSprite.setScale(vinylScale, vinylScale);
+		vinylSprite.setScale(vinylSpriteScale, vinylSpriteScale);
 	}
 
 	if (resourcesFinalized.load() && albumBuffer.getSampleCount() > 0) {
@@ -330,13 +349,16 @@ bool MusicPlayerScene::isActive() const {
 
 void MusicPlayerScene::requestNextAlbum() {
 	if (albums.empty()) return;
-	int next = (currentAlbumIndex + 1) % static_cast<int>(albums.size());
+	//step from the album being loaded so repeated presses during a load keep advancing
+	int base = loadingInProgress.load() ? loadingAlbumIndex.load() : currentAlbumIndex;
+	int next = (base + 1) % static_cast<int>(albums.size());
 	pendingRequestedAlbumIndex = next;
 }
 
 void MusicPlayerScene::requestPrevAlbum() {
 	if (albums.empty()) return;
-	int prev = (currentAlbumIndex - 1 + static_cast<int>(albums.size())) % static_cast<int>(albums.size());
+	int base = loadingInProgress.load() ? loadingAlbumIndex.load() : currentAlbumIndex;
+	int prev = (base - 1 + static_cast<int>(albums.size())) % static_cast<int>(albums.size());
 	pendingRequestedAlbumIndex = prev;
 }
 
@@ -7,6 +7,8 @@
 #include <mutex>
 #include <atomic>
 #include <vector>
+#include "ThreadPool.h"
+#include "CancellationToken.h"
 
 class MusicPlayerScene
 {
@@ -66,12 +68,14 @@ private:
 
 	sf::Texture vinylTexture;
 	sf::Sprite vinylSprite;
-	float vinylScale = 0.6f;
+	float vinylScale = 0.6f; //on-screen size relative to the source image
+	float vinylSpriteScale = 0.6f; //what is left of vinylScale after the image was shrunk on load
 	float vinylRadius = 120.0f;
 	float vinylSpinSpeed = 30.0f; 
 
 	float albumRadius = 120.0f;
 	float albumScale = 1.0f;
+	float albumSpriteScale = 1.0f;
 	float albumVolume = 50.0f;
 
 	sf::Clock frameClock;
@@ -88,9 +92,10 @@ private:
 	std::vector<Album> albums;
 	int currentAlbumIndex = 0;
 
-	std::thread loaderThread;
 	mutable std::mutex pendingMutex;
+	CancellationToken currentLoadToken;
 	sf::Image pendingAlbumImage;                  
+	float pendingAlbumSpriteScale = 1.0f;
 	sf::SoundBuffer pendingSoundBuffer;            
 	std::atomic_bool pendingSoundBufferValid{ false };
 
@@ -105,4 +110,7 @@ private:
 	std::vector<ParallaxLayer> parallaxLayers;
 	float parallaxBaseSpeed = 20.0f;
 	int assetLoadDelayMs = 500;
+
+	//declared last so it is destroyed first, while the members its tasks touch are still alive
+	ThreadPool loaderPool = ThreadPool(2);
 };
\ No newline at end of file
@@ -0,0 +1,16 @@
+#pragma once
+#include <cstdint>
+
+/// <summary>
+/// Weak reference to an object registered with GameObjectManager: a slot index plus the generation the slot
+/// had when the object was added. Deleting the object bumps the slot's generation, so an old handle resolves
+/// to NULL instead of to whatever object reuses the slot. A default constructed handle never resolves.
+/// </summary>
+struct ObjectHandle
+{
+	uint32_t index = 0;
+	uint32_t generation = 0; //slots start at generation 1
+
+	bool operator==(const ObjectHandle& other) const { return this->index == other.index && this->generation == other.generation; }
+	bool operator!=(const ObjectHandle& other) const { return !(*this == other); }
+};
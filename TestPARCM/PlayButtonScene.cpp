@@ -1,5 +1,6 @@
 // PlayButtonScene.cpp
 #include "PlayButtonScene.h"
+#include "AssetPack.h"
 #include <iostream>
 
 PlayButtonScene::PlayButtonScene(sf::RenderWindow* window) : window(window) {
@@ -9,10 +10,10 @@ PlayButtonScene::PlayButtonScene(sf::RenderWindow* window) : window(window) {
     const std::string clickedPath = "Media/UI/Blue/Double/button_rectangle_depth_flat.png";
     const std::string fontPath = "Media/Sansation.ttf";
 
-    if (!buttonTextureNormal.loadFromFile(normalPath)) {
+    if (!AssetPack::getInstance()->loadTexture(buttonTextureNormal, normalPath)) {
         std::cerr << "Failed to load button normal texture: " << normalPath << '\n';
     }
-    if (!buttonTextureClicked.loadFromFile(clickedPath)) {
+    if (!AssetPack::getInstance()->loadTexture(buttonTextureClicked, clickedPath)) {
         std::cerr << "Failed to load button clicked texture: " << clickedPath << '\n';
     }
 
@@ -34,7 +35,7 @@ PlayButtonScene::PlayButtonScene(sf::RenderWindow* window) : window(window) {
 
     buttonBounds = buttonSprite.getGlobalBounds();
 
-    if (!font.loadFromFile(fontPath)) {
+    if (!AssetPack::getInstance()->loadFont(font, fontPath)) {
         std::cerr << "Failed to load font: " << fontPath << '\n';
     }
 
@@ -84,7 +85,8 @@ void PlayButtonScene::loadParallaxLayers(const std::string& folderPath, int coun
     for (int i = 0; i < count; ++i) {
         std::string path = folderPath + "/" + std::to_string(i + 1) + ".png";
         ParallaxLayer &layer = parallaxLayers[i];
-        if (!layer.texture.loadFromFile(path)) {
+        //never stored taller than the window, the layout scales to window height anyway
+        if (!AssetPack::getInstance()->loadTexture(layer.texture, path, sf::Vector2u(0, window->getSize().y))) {
             std::cerr << "PlayButtonScene: failed to load parallax texture: " << path << '\n';
             layer.valid = false;
             continue;
@@ -0,0 +1,106 @@
+#include "SpatialHash.h"
+#include <algorithm>
+#include <cmath>
+
+SpatialHash::SpatialHash(float cellSize)
+{
+	this->cellSize = cellSize;
+}
+
+void SpatialHash::insert(ItemID id, const sf::FloatRect& bounds)
+{
+	CellRange range = this->getRange(bounds);
+	for (int y = range.top; y <= range.bottom; y++) {
+		for (int x = range.left; x <= range.right; x++) {
+			this->cells[getKey(x, y)].push_back(id);
+		}
+	}
+}
+
+void SpatialHash::remove(ItemID id, const sf::FloatRect& bounds)
+{
+	CellRange range = this->getRange(bounds);
+	for (int y = range.top; y <= range.bottom; y++) {
+		for (int x = range.left; x <= range.right; x++) {
+			auto found = this->cells.find(getKey(x, y));
+			if (found == this->cells.end()) continue;
+
+			std::vector<ItemID>& items = found->second;
+			auto item = std::find(items.begin(), items.end(), id);
+			if (item != items.end()) {
+				*item = items.back();
+				items.pop_back();
+			}
+			if (items.empty()) {
+				this->cells.erase(found);
+			}
+		}
+	}
+}
+
+void SpatialHash::move(ItemID id, const sf::FloatRect& oldBounds, const sf::FloatRect& newBounds)
+{
+	//most moves stay inside the same cells
+	CellRange before = this->getRange(oldBounds);
+	CellRange after = this->getRange(newBounds);
+	if (before.left == after.left && before.top == after.top && before.right == after.right && before.bottom == after.bottom) return;
+
+	this->remove(id, oldBounds);
+	this->insert(id, newBounds);
+}
+
+void SpatialHash::clear()
+{
+	this->cells.clear();
+}
+
+void SpatialHash::query(const sf::FloatRect& area, std::vector<ItemID>& out) const
+{
+	out.clear();
+	CellRange range = this->getRange(area);
+
+	//a huge area would walk mostly empty cells, walking the occupied cells is cheaper then
+	int64_t cellCount = static_cast<int64_t>(range.right - range.left + 1) * (range.bottom - range.top + 1);
+	if (cellCount > static_cast<int64_t>(this->cells.size())) {
+		for (const auto& cell : this->cells) {
+			int x = static_cast<int32_t>(cell.first >> 32);
+			int y = static_cast<int32_t>(cell.first & 0xFFFFFFFFu);
+			if (x < range.left || x > range.right || y < range.top || y > range.bottom) continue;
+			out.insert(out.end(), cell.second.begin(), cell.second.end());
+		}
+	}
+	else {
+		for (int y = range.top; y <= range.bottom; y++) {
+			for (int x = range.left; x <= range.right; x++) {
+				auto found = this->cells.find(getKey(x, y));
+				if (found == this->cells.end()) continue;
+				out.insert(out.end(), found->second.begin(), found->second.end());
+			}
+		}
+	}
+
+	//items spanning several cells were picked up once per cell
+	std::sort(out.begin(), out.end());
+	out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+SpatialHash::CellRange SpatialHash::getRange(const sf::FloatRect& bounds) const
+{
+	//bounds may come with a negative size from a flipped scale
+	float left = std::min(bounds.left, bounds.left + bounds.width);
+	float top = std::min(bounds.top, bounds.top + bounds.height);
+	float right = std::max(bounds.left, bounds.left + bounds.width);
+	float bottom = std::max(bounds.top, bounds.top + bounds.height);
+
+	CellRange range;
+	range.left = static_cast<int>(std::floor(left / this->cellSize));
+	range.top = static_cast<int>(std::floor(top / this->cellSize));
+	range.right = static_cast<int>(std::floor(right / this->cellSize));
+	range.bottom = static_cast<int>(std::floor(bottom / this->cellSize));
+	return range;
+}
+
+uint64_t SpatialHash::getKey(int x, int y)
+{
+	return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "SFML/Graphics.hpp"
+
+/// <summary>
+/// Uniform grid over world space for finding items by area. Each item is listed in every cell its bounds touch,
+/// so a query only looks at the cells under the queried area instead of every item. Cells are hashed, the grid
+/// has no fixed extent. The caller keeps the bounds it inserted with and passes them back to move or remove.
+/// Pick a cell size around the typical item size: too small and items span many cells, too large and queries
+/// return many items that then fail the exact test.
+/// </summary>
+class SpatialHash
+{
+public:
+	typedef int ItemID;
+
+	SpatialHash(float cellSize);
+
+	void insert(ItemID id, const sf::FloatRect& bounds);
+	void remove(ItemID id, const sf::FloatRect& bounds);
+	void move(ItemID id, const sf::FloatRect& oldBounds, const sf::FloatRect& newBounds);
+	void clear();
+
+	//every item in a cell overlapping area, sorted and without duplicates. items near the edge of the area
+	//may not overlap it themselves, test their bounds when that matters
+	void query(const sf::FloatRect& area, std::vector<ItemID>& out) const;
+
+private:
+	struct CellRange {
+		int left, top, right, bottom; //inclusive
+	};
+
+	CellRange getRange(const sf::FloatRect& bounds) const;
+	static uint64_t getKey(int x, int y);
+
+	float cellSize;
+	std::unordered_map<uint64_t, std::vector<ItemID>> cells;
+};
@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "StreamingManifest.h"
+
+namespace {
+	int64_t toTicks(std::filesystem::file_time_type time) {
+		return static_cast<int64_t>(time.time_since_epoch().count());
+	}
+}
+
+bool StreamingManifest::load(const String& directory, const String& indexPath)
+{
+	std::error_code error;
+	int64_t directoryTime = toTicks(std::filesystem::last_write_time(directory, error));
+	if (error) {
+		std::cout << "[StreamingManifest] Cannot read " << directory << ": " << error.message() << std::endl;
+		return false;
+	}
+
+	if (this->readIndexFile(indexPath, directoryTime)) {
+		std::cout << "[StreamingManifest] Using cached index " << indexPath << std::endl;
+		return true;
+	}
+
+	if (!this->scanDirectory(directory)) return false;
+	this->writeIndexFile(indexPath, directoryTime);
+	return true;
+}
+
+int StreamingManifest::getCount() const
+{
+	return this->entries.size();
+}
+
+const StreamingManifest::Entry& StreamingManifest::getEntry(int index) const
+{
+	return this->entries[index];
+}
+
+std::vector<StreamingManifest::String> StreamingManifest::getPaths(int maxCount) const
+{
+	std::vector<String> paths;
+	int count = std::min(maxCount, this->getCount());
+	paths.reserve(count);
+	for (int i = 0; i < count; i++) {
+		paths.push_back(this->entries[i].path);
+	}
+	return paths;
+}
+
+bool StreamingManifest::readIndexFile(const String& indexPath, int64_t directoryTime)
+{
+	std::ifstream stream(indexPath);
+	if (!stream) return false;
+
+	//header: version, folder modification time, entry count
+	int version = 0; int64_t recordedTime = 0; int count = 0;
+	String line;
+	if (!std::getline(stream, line)) return false;
+	std::istringstream header(line);
+	if (!(header >> version >> recordedTime >> count)) return false;
+	if (version != INDEX_VERSION || recordedTime != directoryTime || count < 0) return false;
+
+	//one entry per line: size, modification time, then the path up to the end of the line
+	//entries are trusted as written, stat-ing each one again would cost more than the scan this file replaces
+	std::vector<Entry> loaded;
+	loaded.reserve(count);
+	while (std::getline(stream, line)) {
+		std::istringstream fields(line);
+		Entry entry;
+		if (!(fields >> entry.size >> entry.modifiedTime)) return false;
+		fields.get();
+		std::getline(fields, entry.path);
+		loaded.push_back(entry);
+	}
+	if (static_cast<int>(loaded.size()) != count) return false;
+
+	this->entries.swap(loaded);
+	return true;
+}
+
+bool StreamingManifest::scanDirectory(const String& directory)
+{
+	std::error_code error;
+	std::vector<Entry> scanned;
+	for (const auto& file : std::filesystem::directory_iterator(directory, error)) {
+		if (!file.is_regular_file()) continue;
+
+		Entry entry;
+		entry.path = file.path().generic_string();
+		entry.size = file.file_size();
+		entry.modifiedTime = toTicks(file.last_write_time());
+		scanned.push_back(entry);
+	}
+	if (error) {
+		std::cout << "[StreamingManifest] Failed to scan " << directory << ": " << error.message() << std::endl;
+		return false;
+	}
+
+	//directory order is up to the file system, sort so indices mean the same thing everywhere
+	std::sort(scanned.begin(), scanned.end(), [](const Entry& a, const Entry& b) { return a.path < b.path; });
+	this->entries.swap(scanned);
+	return true;
+}
+
+void StreamingManifest::writeIndexFile(const String& indexPath, int64_t directoryTime)
+{
+	std::ofstream stream(indexPath, std::ios::trunc);
+	if (!stream) {
+		std::cout << "[StreamingManifest] Could not write " << indexPath << std::endl;
+		return;
+	}
+
+	stream << INDEX_VERSION << ' ' << directoryTime << ' ' << this->entries.size() << '\n';
+	for (const Entry& entry : this->entries) {
+		stream << entry.size << ' ' << entry.modifiedTime << ' ' << entry.path << '\n';
+	}
+}
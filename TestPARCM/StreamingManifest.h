@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Index of the streaming asset folder: position -> path, file size and modification time, sorted by path.
+/// Built once instead of walking the directory on every lookup. The index is cached in a small text file next
+/// to the folder and reused as long as the folder's own modification time matches, which changes when files are
+/// added, removed or renamed; otherwise the folder is scanned again and the file rewritten. Editing a file in
+/// place leaves the folder time alone and is not detected, delete the index file to force a rescan.
+/// Read-only after load, so lookups are safe from any thread.
+/// </summary>
+class StreamingManifest
+{
+public:
+	typedef std::string String;
+
+	struct Entry {
+		String path;
+		uintmax_t size = 0;
+		int64_t modifiedTime = 0; //file clock ticks, only meaningful for comparisons
+	};
+
+	bool load(const String& directory, const String& indexPath);
+	int getCount() const;
+	const Entry& getEntry(int index) const;
+	std::vector<String> getPaths(int maxCount) const;
+
+private:
+	bool readIndexFile(const String& indexPath, int64_t directoryTime);
+	bool scanDirectory(const String& directory);
+	void writeIndexFile(const String& indexPath, int64_t directoryTime);
+
+	std::vector<Entry> entries;
+	const int INDEX_VERSION = 1;
+};
@@ -0,0 +1,75 @@
+#include "TaskGraph.h"
+#include "MainThreadDispatcher.h"
+
+TaskGraph::TaskGraph(ThreadPool* _pool) {
+	this->graph = make_shared<GraphState>();
+	this->graph->pool = _pool;
+}
+
+TaskGraph::NodeID TaskGraph::AddNode(function<void()> _work, ContinuationTarget _target, TaskPriority _priority) {
+	auto node = make_unique<Node>();
+	node->work = std::move(_work);
+	node->target = _target;
+	node->priority = _priority;
+
+	this->graph->nodes.push_back(std::move(node));
+	return static_cast<NodeID>(this->graph->nodes.size()) - 1;
+}
+
+void TaskGraph::AddDependency(NodeID _before, NodeID _after) {
+	this->graph->nodes[_before]->successors.push_back(_after);
+	this->graph->nodes[_after]->dependencyCount++;
+}
+
+TaskGraph::NodeID TaskGraph::AddStage(NodeID _before, function<void()> _work, ContinuationTarget _target, TaskPriority _priority) {
+	NodeID stage = this->AddNode(std::move(_work), _target, _priority);
+	this->AddDependency(_before, stage);
+	return stage;
+}
+
+void TaskGraph::Launch() {
+	if (this->graph->launched) return;
+	this->graph->launched = true;
+
+	//arm every counter before releasing anything, a root may finish while we are still iterating
+	this->graph->unfinishedNodes = static_cast<int>(this->graph->nodes.size());
+	for (auto& node : this->graph->nodes) {
+		node->remainingDependencies = node->dependencyCount;
+	}
+
+	for (NodeID i = 0; i < static_cast<NodeID>(this->graph->nodes.size()); i++) {
+		if (this->graph->nodes[i]->dependencyCount == 0) {
+			Release(this->graph, i);
+		}
+	}
+}
+
+bool TaskGraph::IsFinished() const {
+	return this->graph->launched && this->graph->unfinishedNodes == 0;
+}
+
+void TaskGraph::Release(shared_ptr<GraphState> _graph, NodeID _node) {
+	Node* node = _graph->nodes[_node].get();
+
+	if (node->target == RUN_ON_MAIN_THREAD || _graph->pool == nullptr) {
+		MainThreadDispatcher::getInstance()->post([_graph, _node]() { Run(_graph, _node); });
+	}
+	else {
+		_graph->pool->ScheduleTask([_graph, _node]() { Run(_graph, _node); }, node->priority);
+	}
+}
+
+void TaskGraph::Run(shared_ptr<GraphState> _graph, NodeID _node) {
+	Node* node = _graph->nodes[_node].get();
+	if (node->work) {
+		node->work();
+	}
+
+	for (NodeID successor : node->successors) {
+		if (--_graph->nodes[successor]->remainingDependencies == 0) {
+			Release(_graph, successor);
+		}
+	}
+
+	_graph->unfinishedNodes--;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "ThreadPool.h"
+#include "TaskHandle.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/// <summary>
+/// Dependency graph of tasks on top of ThreadPool. Each node runs either on a pool worker or on the main thread
+/// (through MainThreadDispatcher) and is released automatically once every node it depends on has finished,
+/// so independent chains such as read -> decode -> upload of different files overlap freely.
+/// Build the graph, then call Launch once; the graph keeps itself alive until its last node ran.
+/// </summary>
+class TaskGraph {
+public:
+	typedef int NodeID;
+
+	TaskGraph(ThreadPool* _pool);
+
+	NodeID AddNode(function<void()> _work, ContinuationTarget _target = RUN_ON_WORKER, TaskPriority _priority = PRIORITY_NORMAL);
+	void AddDependency(NodeID _before, NodeID _after); //_after only starts once _before finished
+	NodeID AddStage(NodeID _before, function<void()> _work, ContinuationTarget _target = RUN_ON_WORKER, TaskPriority _priority = PRIORITY_NORMAL);
+
+	void Launch();
+	bool IsFinished() const;
+
+private:
+	struct Node {
+		function<void()> work;
+		ContinuationTarget target = RUN_ON_WORKER;
+		TaskPriority priority = PRIORITY_NORMAL;
+		vector<NodeID> successors;
+		int dependencyCount = 0;
+		atomic<int> remainingDependencies = 0;
+	};
+
+	struct GraphState {
+		ThreadPool* pool = nullptr;
+		vector<unique_ptr<Node>> nodes;
+		atomic<int> unfinishedNodes = 0;
+		bool launched = false;
+	};
+
+	static void Release(shared_ptr<GraphState> _graph, NodeID _node);
+	static void Run(shared_ptr<GraphState> _graph, NodeID _node);
+
+	shared_ptr<GraphState> graph;
+};
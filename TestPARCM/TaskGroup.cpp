@@ -0,0 +1,50 @@
+#include "TaskGroup.h"
+
+TaskGroup::TaskGroup(ThreadPool* _pool) {
+	this->pool = _pool;
+	this->state = make_shared<SharedState>();
+}
+
+TaskGroup::~TaskGroup() {
+	this->Wait();
+}
+
+TaskHandle TaskGroup::Run(function<void()> _task, TaskPriority _priority) {
+	this->state->pending++;
+	return this->pool->ScheduleTask(Track(this->state, std::move(_task)), _priority);
+}
+
+TaskHandle TaskGroup::Run(IWorkerAction* _task, TaskPriority _priority) {
+	return this->Run([_task]() { _task->OnStartTask(); }, _priority);
+}
+
+void TaskGroup::RunBatch(vector<function<void()>> _tasks, TaskPriority _priority) {
+	for (auto& task : _tasks) {
+		task = Track(this->state, std::move(task));
+	}
+
+	this->state->pending += static_cast<int>(_tasks.size());
+	this->pool->ScheduleTasks(std::move(_tasks), _priority);
+}
+
+function<void()> TaskGroup::Track(shared_ptr<SharedState> _group, function<void()> _task) {
+	return [_group, _task]() {
+		_task();
+
+		if (--_group->pending == 0) {
+			lock_guard<mutex> lock(_group->doneMutex);
+			_group->done.notify_all();
+		}
+	};
+}
+
+void TaskGroup::Wait() {
+	while (this->state->pending > 0) {
+		//the tasks we wait on may still be queued, run them (or anything else) instead of idling
+		if (this->pool->TryRunPendingTask()) continue;
+
+		//everything left is running on other threads
+		unique_lock<mutex> lock(this->state->doneMutex);
+		this->state->done.wait(lock, [this] { return this->state->pending == 0; });
+	}
+}
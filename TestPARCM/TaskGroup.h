@@ -0,0 +1,41 @@
+#pragma once
+
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+/// <summary>
+/// Scoped fork/join over a ThreadPool. Run schedules work and Wait blocks until everything run through this
+/// group finished. While waiting, the calling thread runs queued pool tasks itself and only parks once
+/// nothing is left to pick up. Unlike ThreadPool::WaitAll it is safe to wait on a group from a pool worker.
+/// The destructor waits, so a group on the stack never leaves tasks behind.
+/// </summary>
+class TaskGroup {
+public:
+	TaskGroup(ThreadPool* _pool);
+	~TaskGroup();
+
+	TaskHandle Run(function<void()> _task, TaskPriority _priority = PRIORITY_NORMAL);
+	TaskHandle Run(IWorkerAction* _task, TaskPriority _priority = PRIORITY_NORMAL);
+	void RunBatch(vector<function<void()>> _tasks, TaskPriority _priority = PRIORITY_NORMAL); //see ThreadPool::ScheduleTasks
+	void Wait();
+
+private:
+	struct SharedState {
+		atomic<int> pending = 0;
+		mutex doneMutex;
+		condition_variable done;
+	};
+
+	static function<void()> Track(shared_ptr<SharedState> _group, function<void()> _task);
+
+	TaskGroup(TaskGroup const&) = delete;
+	TaskGroup& operator=(TaskGroup const&) = delete;
+
+	ThreadPool* pool = nullptr;
+	shared_ptr<SharedState> state;
+};
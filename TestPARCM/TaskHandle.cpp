@@ -0,0 +1,94 @@
+#include "TaskHandle.h"
+#include "ThreadPool.h"
+#include "MainThreadDispatcher.h"
+
+void TaskState::OnStartTask() {
+	if (this->action != nullptr) {
+		this->action->OnStartTask();
+	}
+	if (this->function) {
+		this->function();
+	}
+
+	this->Complete();
+}
+
+void TaskState::AddContinuation(std::shared_ptr<TaskState> _next, ContinuationTarget _target) {
+	{
+		std::lock_guard<std::mutex> lock(this->continuationMutex);
+		if (!this->finished) {
+			this->continuations.push_back({ _next, _target });
+			return;
+		}
+	}
+
+	this->Release({ _next, _target });
+}
+
+void TaskState::Complete() {
+	std::vector<Continuation> ready;
+	{
+		std::lock_guard<std::mutex> lock(this->continuationMutex);
+		this->finished = true;
+		ready.swap(this->continuations);
+	}
+
+	for (const Continuation& continuation : ready) {
+		this->Release(continuation);
+	}
+}
+
+void TaskState::Release(const Continuation& _continuation) {
+	std::shared_ptr<TaskState> next = _continuation.task;
+
+	if (_continuation.target == RUN_ON_WORKER && next->owner != nullptr) {
+		next->owner->Submit(next);
+	}
+	else {
+		next->claimed = true;
+		MainThreadDispatcher::getInstance()->post([next]() { next->OnStartTask(); });
+	}
+}
+
+TaskHandle::TaskHandle() {}
+
+TaskHandle::TaskHandle(std::shared_ptr<TaskState> _state) {
+	this->state = _state;
+}
+
+bool TaskHandle::IsValid() const {
+	return this->state != nullptr;
+}
+
+bool TaskHandle::HasStarted() const {
+	return this->state != nullptr && this->state->claimed;
+}
+
+TaskPriority TaskHandle::GetPriority() const {
+	if (this->state == nullptr) return PRIORITY_NORMAL;
+	return static_cast<TaskPriority>(this->state->priority.load());
+}
+
+void TaskHandle::SetPriority(TaskPriority _priority) {
+	if (this->state == nullptr || this->state->owner == nullptr) return;
+	this->state->owner->Reprioritize(this->state, _priority);
+}
+
+TaskHandle TaskHandle::Then(std::function<void()> _callback, ContinuationTarget _target) {
+	auto next = std::make_shared<TaskState>();
+	next->function = std::move(_callback);
+
+	if (this->state != nullptr) {
+		next->owner = this->state->owner;
+		next->priority = this->state->priority.load();
+		this->state->AddContinuation(next, _target);
+	}
+	else {
+		//nothing to wait for, release right away
+		auto done = std::make_shared<TaskState>();
+		done->OnStartTask();
+		done->AddContinuation(next, _target);
+	}
+
+	return TaskHandle(next);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "IWorkerAction.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class ThreadPool;
+
+enum TaskPriority { PRIORITY_HIGH = 0, PRIORITY_NORMAL = 1, PRIORITY_LOW = 2, PRIORITY_COUNT = 3 };
+enum ContinuationTarget { RUN_ON_MAIN_THREAD = 0, RUN_ON_WORKER = 1 };
+
+/// <summary>
+/// Shared bookkeeping for one scheduled task. A task may sit in several priority queues at once after being
+/// re-prioritized; only the entry matching the current priority can claim it, the rest are discarded.
+/// Delayed tasks and continuations are not queued until their timer fires or their predecessor finishes,
+/// until then a new priority is only stored and used once they are submitted.
+/// Continuations attached before the task finishes are released by Complete, later ones are released at once.
+/// </summary>
+struct TaskState : public IWorkerAction {
+	IWorkerAction* action = nullptr;
+	std::function<void()> function;
+	ThreadPool* owner = nullptr;
+	std::atomic<int> priority = PRIORITY_NORMAL;
+	std::atomic<bool> queued = false; //set by ThreadPool::Submit, before that there is no entry to re-queue
+	std::atomic<bool> claimed = false;
+
+	void OnStartTask() override;
+	void AddContinuation(std::shared_ptr<TaskState> _next, ContinuationTarget _target);
+
+private:
+	struct Continuation {
+		std::shared_ptr<TaskState> task;
+		ContinuationTarget target;
+	};
+
+	void Complete();
+	void Release(const Continuation& _continuation);
+
+	std::mutex continuationMutex;
+	bool finished = false;
+	std::vector<Continuation> continuations;
+};
+
+/// <summary>
+/// Returned by ThreadPool::ScheduleTask. Lets the caller query or change the priority of a task
+/// until a worker picks it up, and chain work to run after it with Then.
+/// A continuation's priority can be set before its predecessor finished; it is only recorded then and
+/// used once the continuation is released.
+/// </summary>
+class TaskHandle {
+public:
+	TaskHandle();
+
+	bool IsValid() const;
+	bool HasStarted() const;
+	TaskPriority GetPriority() const;
+	void SetPriority(TaskPriority _priority);
+
+	//runs _callback once this task finished. by default the callback is marshalled to the main thread and
+	//runs inside MainThreadDispatcher::drainQueue. the returned handle can be chained again.
+	TaskHandle Then(std::function<void()> _callback, ContinuationTarget _target = RUN_ON_MAIN_THREAD);
+
+private:
+	friend class ThreadPool;
+	TaskHandle(std::shared_ptr<TaskState> _state);
+
+	std::shared_ptr<TaskState> state;
+};
@@ -0,0 +1,115 @@
+#include "TaskSelfTest.h"
+#include "ThreadPool.h"
+#include "MainThreadDispatcher.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+namespace {
+	int failures = 0;
+
+	void check(bool condition, const char* name)
+	{
+		std::printf("  %-60s %s\n", name, condition ? "ok" : "FAILED");
+		if (!condition) failures++;
+	}
+
+	void sleepMs(int ms)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+	}
+
+	//keeps the pool's only worker busy until open is set, so whatever is scheduled next stays queued
+	TaskHandle block(ThreadPool& pool, std::atomic<bool>& open)
+	{
+		std::atomic<bool> started = false;
+		TaskHandle handle = pool.ScheduleTask([&open, &started]() {
+			started = true;
+			while (!open) sleepMs(1);
+		});
+		while (!started) sleepMs(1);
+		return handle;
+	}
+
+	void queuedTask()
+	{
+		ThreadPool pool(1);
+		pool.StartScheduling();
+
+		std::atomic<bool> open = false;
+		block(pool, open);
+
+		std::atomic<int> runs = 0;
+		TaskHandle task = pool.ScheduleTask([&runs]() { runs++; sleepMs(20); }, PRIORITY_LOW);
+		task.SetPriority(PRIORITY_HIGH);
+		task.SetPriority(PRIORITY_NORMAL);
+		open = true;
+		pool.WaitAll();
+
+		check(runs == 1, "queued task runs once after two priority changes");
+		check(task.GetPriority() == PRIORITY_NORMAL, "queued task keeps its last priority");
+	}
+
+	void delayedTask()
+	{
+		ThreadPool pool(1);
+		pool.StartScheduling();
+
+		std::atomic<int> runs = 0;
+		TaskHandle task = pool.ScheduleDelayed([&runs]() { runs++; }, 100, PRIORITY_LOW);
+		task.SetPriority(PRIORITY_HIGH);
+
+		bool ranEarly = pool.TryRunPendingTask();
+		sleepMs(30);
+		check(!ranEarly && runs == 0, "delayed task waits for its timer after a priority change");
+
+		sleepMs(120);
+		pool.WaitAll();
+		check(runs == 1, "delayed task runs once");
+
+		//an unbalanced task count would let WaitAll return before this one finished
+		std::atomic<bool> finished = false;
+		pool.ScheduleTask([&finished]() { sleepMs(50); finished = true; });
+		pool.WaitAll();
+		check(finished, "WaitAll still waits after a delayed task was reprioritized");
+	}
+
+	void continuation(ContinuationTarget target, const char* early, const char* once)
+	{
+		ThreadPool pool(1);
+		pool.StartScheduling();
+
+		std::atomic<bool> open = false;
+		TaskHandle predecessor = block(pool, open);
+
+		std::atomic<int> runs = 0;
+		TaskHandle next = predecessor.Then([&runs]() { runs++; }, target);
+		next.SetPriority(PRIORITY_HIGH);
+
+		//the only worker is stuck in the predecessor, so anything runnable would be picked up here
+		bool ranEarly = pool.TryRunPendingTask();
+		check(!ranEarly && runs == 0, early);
+
+		open = true;
+		pool.WaitAll();
+		MainThreadDispatcher::getInstance()->drainQueue();
+		pool.TryRunPendingTask();
+		MainThreadDispatcher::getInstance()->drainQueue();
+		check(runs == 1 && next.GetPriority() == PRIORITY_HIGH, once);
+	}
+}
+
+bool TaskSelfTest::run()
+{
+	failures = 0;
+	std::printf("[TaskSelfTest]\n");
+
+	queuedTask();
+	delayedTask();
+	continuation(RUN_ON_WORKER, "worker continuation waits for its predecessor", "worker continuation runs once at the new priority");
+	continuation(RUN_ON_MAIN_THREAD, "main thread continuation waits for its predecessor", "main thread continuation runs once");
+
+	std::printf("[TaskSelfTest] %s\n", failures == 0 ? "all passed" : "FAILED");
+	return failures == 0;
+}
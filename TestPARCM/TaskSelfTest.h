@@ -0,0 +1,13 @@
+#pragma once
+
+/// <summary>
+/// Exercises the ThreadPool task bookkeeping that is easy to break and hard to notice in the player: changing the
+/// priority of a task at each point of its life must neither run it early or twice nor unbalance WaitAll.
+/// Prints one line per check and returns false if any failed.
+/// Run with: TestPARCM --test-tasks
+/// </summary>
+class TaskSelfTest
+{
+public:
+	static bool run();
+};
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include "TextureAtlas.h"
+
+TextureAtlas::TextureAtlas(unsigned int pageSize)
+{
+	this->pageSize = pageSize;
+}
+
+TextureAtlas::~TextureAtlas()
+{
+	for (sf::Texture* page : this->pages) {
+		delete page;
+	}
+}
+
+bool TextureAtlas::pack(const sf::Image& image, TextureRegion& region)
+{
+	sf::Vector2u size = image.getSize();
+	unsigned int cellWidth = size.x + PADDING * 2;
+	unsigned int cellHeight = size.y + PADDING * 2;
+	if (size.x == 0 || size.y == 0 || cellWidth > this->pageSize || cellHeight > this->pageSize) return false;
+
+	if (this->pages.empty()) {
+		this->addPage();
+	}
+
+	//row is full, open a new shelf below the tallest image of the current one
+	if (this->cursorX + cellWidth > this->pageSize) {
+		this->cursorX = 0;
+		this->shelfY += this->shelfHeight;
+		this->shelfHeight = 0;
+	}
+
+	//page is full
+	if (this->shelfY + cellHeight > this->pageSize) {
+		this->addPage();
+	}
+
+	unsigned int x = this->cursorX + PADDING;
+	unsigned int y = this->shelfY + PADDING;
+	sf::Texture* page = this->pages.back();
+	page->update(image, x, y);
+
+	this->cursorX += cellWidth;
+	this->shelfHeight = std::max(this->shelfHeight, cellHeight);
+
+	region.texture = page;
+	region.rect = sf::IntRect(x, y, size.x, size.y);
+	return true;
+}
+
+int TextureAtlas::getNumPages() const
+{
+	return this->pages.size();
+}
+
+unsigned int TextureAtlas::getPageSize() const
+{
+	return this->pageSize;
+}
+
+sf::Texture* TextureAtlas::getPage(int index)
+{
+	return this->pages[index];
+}
+
+void TextureAtlas::addPage()
+{
+	if (this->pages.empty()) {
+		this->pageSize = std::min(this->pageSize, sf::Texture::getMaximumSize());
+	}
+
+	//start from a cleared page so the padding gutters are transparent rather than whatever the driver hands out
+	sf::Image blank;
+	blank.create(this->pageSize, this->pageSize, sf::Color::Transparent);
+
+	sf::Texture* page = new sf::Texture();
+	page->loadFromImage(blank);
+	this->pages.push_back(page);
+
+	this->cursorX = 0;
+	this->shelfY = 0;
+	this->shelfHeight = 0;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <vector>
+#include "SFML/Graphics.hpp"
+
+/// <summary>
+/// A texture, or the part of an atlas page, that an object draws from.
+/// </summary>
+struct TextureRegion {
+	sf::Texture* texture = nullptr;
+	sf::IntRect rect;
+};
+
+/// <summary>
+/// Packs small images into a few large texture pages using a shelf packer: images are placed left to right
+/// on the current shelf, a new shelf starts below once a row is full, and a new page once the page is full.
+/// Every image keeps a transparent gutter of PADDING pixels so neighbours never bleed into each other.
+/// pack creates and updates GL textures, so it must run on the main thread.
+/// </summary>
+class TextureAtlas
+{
+public:
+	TextureAtlas(unsigned int pageSize = DEFAULT_PAGE_SIZE);
+	~TextureAtlas();
+
+	bool pack(const sf::Image& image, TextureRegion& region); //false if the image does not fit on an empty page
+	int getNumPages() const;
+	unsigned int getPageSize() const;
+	sf::Texture* getPage(int index);
+
+	static const unsigned int DEFAULT_PAGE_SIZE = 2048;
+	static const unsigned int PADDING = 1;
+
+private:
+	TextureAtlas(TextureAtlas const&) {};             // copy constructor is private
+	TextureAtlas& operator=(TextureAtlas const&) { return *this; };  // assignment operator is private
+
+	void addPage();
+
+	std::vector<sf::Texture*> pages;
+	unsigned int pageSize = DEFAULT_PAGE_SIZE;
+	unsigned int cursorX = 0;
+	unsigned int shelfY = 0;
+	unsigned int shelfHeight = 0;
+};
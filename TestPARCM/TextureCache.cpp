@@ -0,0 +1,132 @@
+#include <iostream>
+#include "TextureCache.h"
+
+TextureCache::TextureCache(size_t budgetBytes)
+{
+	this->stats.budgetBytes = budgetBytes;
+}
+
+void TextureCache::insert(sf::Texture* texture, ReloadFunction reload)
+{
+	if (this->entries.count(texture) != 0) return;
+
+	Entry& entry = this->entries[texture];
+	entry.reload = std::move(reload);
+	entry.bytes = getTextureBytes(*texture);
+	this->lruList.push_front(texture);
+	entry.lruPosition = this->lruList.begin();
+	this->stats.residentBytes += entry.bytes;
+
+	this->evictToBudget(texture);
+}
+
+void TextureCache::erase(sf::Texture* texture)
+{
+	auto found = this->entries.find(texture);
+	if (found == this->entries.end()) return;
+
+	if (found->second.resident) {
+		this->lruList.erase(found->second.lruPosition);
+		this->stats.residentBytes -= found->second.bytes;
+	}
+	this->entries.erase(found);
+}
+
+bool TextureCache::acquire(sf::Texture* texture)
+{
+	auto found = this->entries.find(texture);
+	if (found == this->entries.end()) return false;
+	Entry& entry = found->second;
+
+	if (entry.resident) {
+		this->stats.hits++;
+		this->lruList.splice(this->lruList.begin(), this->lruList, entry.lruPosition);
+		return true;
+	}
+
+	this->stats.misses++;
+	if (!entry.reload || !entry.reload(*texture)) {
+		std::cout << "[TextureCache] Failed to reload evicted texture" << std::endl;
+		return false;
+	}
+
+	//a fresh sf::Texture forgets its sampling flags, put back what the owner had set
+	texture->setRepeated(entry.repeated);
+	texture->setSmooth(entry.smooth);
+
+	entry.resident = true;
+	entry.bytes = getTextureBytes(*texture);
+	this->lruList.push_front(texture);
+	entry.lruPosition = this->lruList.begin();
+	this->stats.residentBytes += entry.bytes;
+
+	this->evictToBudget(texture);
+	return true;
+}
+
+void TextureCache::pin(sf::Texture* texture)
+{
+	auto found = this->entries.find(texture);
+	if (found == this->entries.end()) return;
+
+	//callers acquire first, so this only refreshes the position and leaves the hit and miss counts alone
+	Entry& entry = found->second;
+	if (entry.resident) {
+		this->lruList.splice(this->lruList.begin(), this->lruList, entry.lruPosition);
+	}
+	entry.pins++;
+}
+
+void TextureCache::unpin(sf::Texture* texture)
+{
+	auto found = this->entries.find(texture);
+	if (found == this->entries.end() || found->second.pins == 0) return;
+
+	found->second.pins--;
+	this->evictToBudget(nullptr);
+}
+
+void TextureCache::setBudget(size_t budgetBytes)
+{
+	this->stats.budgetBytes = budgetBytes;
+	this->evictToBudget(nullptr);
+}
+
+TextureCache::Stats TextureCache::getStats() const
+{
+	return this->stats;
+}
+
+size_t TextureCache::getTextureBytes(const sf::Texture& texture)
+{
+	sf::Vector2u size = texture.getSize();
+	return static_cast<size_t>(size.x) * size.y * 4;
+}
+
+void TextureCache::evictToBudget(sf::Texture* keep)
+{
+	//walk from the least recently used end, skipping whatever is pinned or was just touched
+	auto position = this->lruList.end();
+	while (this->stats.residentBytes > this->stats.budgetBytes && position != this->lruList.begin()) {
+		--position;
+		sf::Texture* texture = *position;
+		Entry& entry = this->entries[texture];
+		if (texture == keep || entry.pins > 0) continue;
+
+		position = this->lruList.erase(position);
+		this->evict(texture, entry);
+	}
+}
+
+void TextureCache::evict(sf::Texture* texture, Entry& entry)
+{
+	entry.repeated = texture->isRepeated();
+	entry.smooth = texture->isSmooth();
+	entry.resident = false;
+
+	//frees the GL texture but keeps the object, so pointers held elsewhere stay valid
+	*texture = sf::Texture();
+
+	this->stats.residentBytes -= entry.bytes;
+	this->stats.evictions++;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include "SFML/Graphics.hpp"
+
+/// <summary>
+/// Byte-budgeted LRU over GPU textures. Entries are keyed by the texture pointer, which stays valid for the
+/// lifetime of the program: eviction frees the pixels in place (the sf::Texture becomes empty) and acquire
+/// brings them back through the entry's reload function. Pinned textures are in use by something on screen
+/// and are never evicted, so the budget can only be exceeded by pinned textures.
+/// Creates and frees GL textures, so every call must come from the main thread.
+/// </summary>
+class TextureCache
+{
+public:
+	typedef std::function<bool(sf::Texture& texture)> ReloadFunction;
+
+	struct Stats {
+		uint64_t hits = 0;
+		uint64_t misses = 0; //acquires that had to reload an evicted texture
+		uint64_t evictions = 0;
+		size_t residentBytes = 0;
+		size_t budgetBytes = 0;
+	};
+
+	TextureCache(size_t budgetBytes);
+
+	void insert(sf::Texture* texture, ReloadFunction reload); //texture must already hold its pixels
+	void erase(sf::Texture* texture); //stops tracking, call before deleting the texture
+	bool acquire(sf::Texture* texture); //marks as recently used, reloading if evicted. false if unknown or reload failed
+	void pin(sf::Texture* texture); //keeps an acquired texture resident until unpin, does not reload
+	void unpin(sf::Texture* texture);
+	void setBudget(size_t budgetBytes);
+	Stats getStats() const;
+
+	static size_t getTextureBytes(const sf::Texture& texture);
+
+private:
+	struct Entry {
+		ReloadFunction reload;
+		size_t bytes = 0;
+		int pins = 0;
+		bool resident = true;
+		bool repeated = false;
+		bool smooth = false;
+		std::list<sf::Texture*>::iterator lruPosition;
+	};
+
+	void evictToBudget(sf::Texture* keep);
+	void evict(sf::Texture* texture, Entry& entry);
+
+	std::unordered_map<sf::Texture*, Entry> entries;
+	std::list<sf::Texture*> lruList; //resident textures only, most recently used first
+	Stats stats;
+};
@@ -1,35 +1,66 @@
 #include "TextureDisplay.h"
+#include <algorithm>
 #include <iostream>
 #include "TextureManager.h"
 #include "BaseRunner.h"
 #include "GameObjectManager.h"
 #include "IconObject.h"
-TextureDisplay::TextureDisplay(): AGameObject("TextureDisplay")
+#include "MainThreadDispatcher.h"
+#include "TaskGraph.h"
+#include "TextureUploader.h"
+TextureDisplay::TextureDisplay(StreamingType streamingType): AGameObject("TextureDisplay")
 {
-	
+	this->streamingType = streamingType;
 }
 
 void TextureDisplay::initialize()
 {
+	//drawn before the entities, so it sits in the gap between grid cells instead of over the icon
+	this->selectionOutline.setFillColor(sf::Color::Transparent);
+	this->selectionOutline.setOutlineColor(sf::Color::Yellow);
+	this->selectionOutline.setOutlineThickness(2.0f);
+
+	TextureManager::getInstance()->setStreamingTileSize(sf::Vector2u(ICON_CELL_SIZE, ICON_CELL_SIZE));
 	threadPool.StartScheduling();
 }
 
 void TextureDisplay::processInput(sf::Event event)
 {
-	
+	//the runner keeps the default view, so window pixels are world coordinates
+	if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
+		sf::Vector2f point(static_cast<float>(event.mouseButton.x), static_cast<float>(event.mouseButton.y));
+		AGameObject* icon = GameObjectManager::getInstance()->findObjectAt(point);
+		this->selectedIcon = icon != NULL ? icon->getHandle() : ObjectHandle();
+	}
+}
+
+void TextureDisplay::draw(sf::RenderWindow* targetWindow)
+{
+	AGameObject* icon = GameObjectManager::getInstance()->findObject(this->selectedIcon);
+	if (icon == NULL) return;
+
+	sf::FloatRect bounds = icon->getLocalBounds();
+	sf::Vector2f scale = icon->getScale();
+	this->selectionOutline.setPosition(icon->getPosition());
+	this->selectionOutline.setSize(sf::Vector2f(bounds.width * scale.x, bounds.height * scale.y));
+	targetWindow->draw(this->selectionOutline);
 }
 
 void TextureDisplay::OnFinishedExecution() {
 	//this->spawnObject();
 
-	//Spawning by batches
-	int start = 0; int end = 0;
-	for (int i = 0; i < 4; i++) {
-		IETThread::sleep(1000);
-		start = i * (TextureManager::getInstance()->getNumLoadedStreamTextures() / 4);
-		end = start + (TextureManager::getInstance()->getNumLoadedStreamTextures() / 4);
-		for (int j = start; j < end; j++) this->spawnObject();
-	}
+	//the loader only decoded the tiles, wait until the last of them is uploaded before counting textures.
+	//spawning by batches, one second apart, as delayed main thread callbacks instead of sleeping.
+	TextureUploader::getInstance()->runAfterPending([this]() {
+		int start = 0; int end = 0;
+		for (int i = 0; i < 4; i++) {
+			start = i * (TextureManager::getInstance()->getNumLoadedStreamTextures() / 4);
+			end = start + (TextureManager::getInstance()->getNumLoadedStreamTextures() / 4);
+			MainThreadDispatcher::getInstance()->postDelayed([this, start, end]() {
+				for (int j = start; j < end; j++) this->spawnObject();
+				}, (i + 1) * 1000);
+		}
+	});
 }
 
 void TextureDisplay::update(sf::Time deltaTime)
@@ -52,14 +83,87 @@ void TextureDisplay::update(sf::Time deltaTime)
 	*/
 
 	//Batch Loader
-	if (!this->startedStreaming && ticks > STREAMING_LOAD_DELAY) {
+	if (this->streamingType == BATCH_LOAD && !this->startedStreaming && ticks > STREAMING_LOAD_DELAY) {
+		this->startedStreaming = true;
+		this->ticks = 0.0f;
+		LoadAssetThread* batch = new LoadAssetThread(MAX_STREAMED_TEXTURES, this, &threadPool, STREAMING_THROTTLE_MS);
+		threadPool.ScheduleTask(batch, PRIORITY_LOW); //speculative prefetch, user-facing loads go ahead of it
+	}
+
+	//Pipelined Loader
+	if (this->streamingType == PIPELINE_LOAD && !this->startedStreaming && ticks > STREAMING_LOAD_DELAY) {
+		this->startedStreaming = true;
+		this->ticks = 0.0f;
+		this->launchStreamingPipeline();
+	}
+
+	//Parallel Loader
+	if (this->streamingType == PARALLEL_LOAD && !this->startedStreaming && ticks > STREAMING_LOAD_DELAY) {
 		this->startedStreaming = true;
 		this->ticks = 0.0f;
-		LoadAssetThread* batch = new LoadAssetThread(150, this);
-		threadPool.ScheduleTask(batch);
+		this->launchParallelLoad();
 	}
 }
 
+void TextureDisplay::launchStreamingPipeline()
+{
+	//every tile is its own read -> decode -> upload -> spawn chain, so disk reads, decodes
+	//and main thread uploads of different tiles overlap instead of running one after another
+	struct StreamedTile {
+		String path;
+		AssetBytes bytes;
+	};
+
+	TaskGraph graph(&this->threadPool);
+	std::vector<String> paths = TextureManager::getInstance()->getStreamingAssetPaths(MAX_STREAMED_TEXTURES);
+
+	for (const String& path : paths) {
+		auto tile = std::make_shared<StreamedTile>();
+		tile->path = path;
+
+		TaskGraph::NodeID read = graph.AddNode([tile]() {
+			TextureManager::getInstance()->readAssetBytes(tile->path, tile->bytes);
+			}, RUN_ON_WORKER, PRIORITY_LOW);
+
+		//the texture itself is created by TextureUploader within the per-frame budget
+		graph.AddStage(read, [this, tile]() {
+			auto image = std::make_shared<sf::Image>();
+			if (!TextureManager::getInstance()->decodeImage(tile->path, tile->bytes, *image, true)) return;
+			tile->bytes.clear();
+
+			TextureUploader::getInstance()->enqueue(tile->path, image, true,
+				[this](sf::Texture*) { this->spawnObject(); });
+			}, RUN_ON_WORKER, PRIORITY_LOW);
+	}
+
+	graph.Launch();
+}
+
+void TextureDisplay::launchParallelLoad()
+{
+	//the streaming index is split into grain sized chunks that go to the pool in one batch. nothing waits on
+	//them, ParallelFor would block the frame here, and every decoded tile is handed to TextureUploader right away
+	auto paths = std::make_shared<std::vector<String>>(TextureManager::getInstance()->getStreamingAssetPaths(MAX_STREAMED_TEXTURES));
+
+	std::vector<std::function<void()>> chunks;
+	for (int begin = 0; begin < static_cast<int>(paths->size()); begin += STREAMING_GRAIN) {
+		int end = std::min(static_cast<int>(paths->size()), begin + STREAMING_GRAIN);
+		chunks.push_back([this, paths, begin, end]() {
+			for (int i = begin; i < end; i++) {
+				const String& path = (*paths)[i];
+				AssetBytes bytes;
+				auto image = std::make_shared<sf::Image>();
+				if (!TextureManager::getInstance()->readAssetBytes(path, bytes)) continue;
+				if (!TextureManager::getInstance()->decodeImage(path, bytes, *image, true)) continue;
+
+				TextureUploader::getInstance()->enqueue(path, image, true,
+					[this](sf::Texture*) { this->spawnObject(); });
+			}
+		});
+	}
+
+	this->threadPool.ScheduleTasks(std::move(chunks), PRIORITY_LOW);
+}
 
 void TextureDisplay::spawnObject()
 {
@@ -68,9 +172,8 @@ void TextureDisplay::spawnObject()
 	this->iconList.push_back(iconObj);
 
 	//set position
-	int IMG_WIDTH = 68; int IMG_HEIGHT = 68;
-	float x = this->columnGrid * IMG_WIDTH;
-	float y = this->rowGrid * IMG_HEIGHT;
+	float x = this->columnGrid * ICON_CELL_SIZE;
+	float y = this->rowGrid * ICON_CELL_SIZE;
 	iconObj->setPosition(x, y);
 
 	std::cout << "Set position: " << x << " " << y << std::endl;
@@ -11,10 +11,15 @@ class IconObject;
 class TextureDisplay: public AGameObject, public IExecutionEvent
 {
 public:
-	TextureDisplay();
+	//BATCH_LOAD: one task loads every tile in turn. PIPELINE_LOAD: a read -> decode -> upload chain per tile.
+	//PARALLEL_LOAD: the tile list is split into chunks decoded side by side. SINGLE_STREAM is not wired up.
+	enum StreamingType { BATCH_LOAD = 0, SINGLE_STREAM = 1, PIPELINE_LOAD = 2, PARALLEL_LOAD = 3 };
+
+	TextureDisplay(StreamingType streamingType = PARALLEL_LOAD);
 	void initialize();
 	void processInput(sf::Event event);
 	void update(sf::Time deltaTime);
+	void draw(sf::RenderWindow* targetWindow) override;
 
 	void OnFinishedExecution() override;
 
@@ -22,11 +27,18 @@ private:
 	typedef std::vector<IconObject*> IconList;
 	IconList iconList;
 
+	//icon picked with the left mouse button, outlined until another click. empty once the icon is deleted
+	ObjectHandle selectedIcon;
+	sf::RectangleShape selectionOutline;
+
 	ThreadPool threadPool = ThreadPool(5);
 
-	enum StreamingType { BATCH_LOAD = 0, SINGLE_STREAM = 1 };
 	const float STREAMING_LOAD_DELAY = 50.0f;
-	const StreamingType streamingType = BATCH_LOAD;
+	StreamingType streamingType;
+	const int MAX_STREAMED_TEXTURES = 150;
+	const int STREAMING_THROTTLE_MS = 20;
+	const int STREAMING_GRAIN = 8; //tiles per parallel load chunk
+	static const unsigned int ICON_CELL_SIZE = 68; //grid spacing, larger tiles are shrunk to it on decode
 	float ticks = 0.0f;
 	bool startedStreaming = false;
 
@@ -36,5 +48,7 @@ private:
 	const int MAX_ROW = 20;
 
 	void spawnObject();
+	void launchStreamingPipeline();
+	void launchParallelLoad();
 };
 
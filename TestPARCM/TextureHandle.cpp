@@ -0,0 +1,72 @@
+#include <utility>
+#include "TextureHandle.h"
+#include "TextureManager.h"
+
+TextureHandle::TextureHandle() {}
+
+TextureHandle::TextureHandle(int slot, uint32_t generation)
+{
+	this->slot = slot;
+	this->generation = generation;
+}
+
+TextureHandle::TextureHandle(const TextureHandle& other)
+{
+	if (other.slot != -1 && TextureManager::getInstance()->retainSlot(other.slot, other.generation)) {
+		this->slot = other.slot;
+		this->generation = other.generation;
+	}
+}
+
+TextureHandle::TextureHandle(TextureHandle&& other) noexcept
+{
+	std::swap(this->slot, other.slot);
+	std::swap(this->generation, other.generation);
+}
+
+TextureHandle& TextureHandle::operator=(TextureHandle other)
+{
+	std::swap(this->slot, other.slot);
+	std::swap(this->generation, other.generation);
+	return *this;
+}
+
+TextureHandle::~TextureHandle()
+{
+	this->reset();
+}
+
+bool TextureHandle::isValid() const
+{
+	return this->slot != -1 && TextureManager::getInstance()->resolveSlot(this->slot, this->generation) != NULL;
+}
+
+bool TextureHandle::isExpired() const
+{
+	return this->slot != -1 && !this->isValid();
+}
+
+sf::Texture* TextureHandle::get() const
+{
+	if (this->slot == -1) return NULL;
+
+	const TextureRegion* region = TextureManager::getInstance()->resolveSlot(this->slot, this->generation);
+	return region != NULL ? region->texture : NULL;
+}
+
+sf::IntRect TextureHandle::getRect() const
+{
+	if (this->slot == -1) return sf::IntRect();
+
+	const TextureRegion* region = TextureManager::getInstance()->resolveSlot(this->slot, this->generation);
+	return region != NULL ? region->rect : sf::IntRect();
+}
+
+void TextureHandle::reset()
+{
+	if (this->slot == -1) return;
+
+	TextureManager::getInstance()->releaseSlot(this->slot, this->generation);
+	this->slot = -1;
+	this->generation = 0;
+}
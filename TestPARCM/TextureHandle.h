@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include "SFML/Graphics.hpp"
+
+/// <summary>
+/// Counted reference to a texture (or atlas region) owned by TextureManager, used instead of holding a raw
+/// sf::Texture*. The handle names a registry slot plus the generation it was issued for: while any handle to a
+/// slot is alive its texture stays resident, once the last one is gone the cache may evict it. Unloading a
+/// texture bumps the slot's generation, so handles still pointing at it report isExpired instead of dangling.
+/// Copy, resolve and drop handles on the main thread.
+/// </summary>
+class TextureHandle
+{
+public:
+	TextureHandle();
+	TextureHandle(const TextureHandle& other);
+	TextureHandle(TextureHandle&& other) noexcept;
+	TextureHandle& operator=(TextureHandle other);
+	~TextureHandle();
+
+	bool isValid() const;
+	bool isExpired() const; //referred to a texture that has since been unloaded
+	sf::Texture* get() const; //NULL unless valid
+	sf::IntRect getRect() const; //part of the texture to draw, the whole texture unless atlased
+	void reset();
+
+private:
+	friend class TextureManager;
+	TextureHandle(int slot, uint32_t generation); //takes over a reference already counted by TextureManager
+
+	int slot = -1;
+	uint32_t generation = 0;
+};
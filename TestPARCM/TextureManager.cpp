@@ -1,9 +1,14 @@
 #include <fstream>
 #include <iostream>
-#include <filesystem>
+#include <algorithm>
+#include <thread>
 #include "TextureManager.h"
 #include "StringUtils.h"
 #include "IETThread.h"
+#include "ThreadPool.h"
+#include "TaskGroup.h"
+#include "TextureUploader.h"
+#include "DecodedImageCache.h"
 
 //a singleton class
 TextureManager* TextureManager::sharedInstance = NULL;
@@ -29,30 +34,57 @@ void TextureManager::loadFromAssetList()
 	std::ifstream stream("Media/assets.txt");
 	String path;
 
+	std::vector<String> paths;
 	while(std::getline(stream, path))
 	{
-		std::vector<String> tokens = StringUtils::split(path, '/');
-		String assetName = StringUtils::split(tokens[tokens.size() - 1], '.')[0];
-		this->instantiateAsTexture(path, assetName, false);
+		paths.push_back(path);
+	}
+
+	//reading and decoding fan out over a short-lived pool, the calling thread helps while it waits
+	std::vector<sf::Image> images(paths.size());
+	std::vector<char> decoded(paths.size(), 0); //not vector<bool>, workers write neighbouring entries concurrently
+	{
+		ThreadPool pool(static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+		pool.StartScheduling();
+
+		TaskGroup group(&pool);
+		for (size_t i = 0; i < paths.size(); i++) {
+			group.Run([this, &paths, &images, &decoded, i]() {
+				AssetBytes bytes;
+				if (this->readAssetBytes(paths[i], bytes) && this->decodeImage(paths[i], bytes, images[i])) {
+					decoded[i] = 1;
+				}
+			});
+		}
+		group.Wait();
+	}
+
+	//textures are created here, in list order, so the frame order of animated assets is kept
+	for (size_t i = 0; i < paths.size(); i++)
+	{
+		String assetName = getAssetName(paths[i]);
+		if (decoded[i]) {
+			this->uploadTexture(paths[i], images[i], false);
+		}
+		else {
+			this->instantiateAsTexture(paths[i], false);
+		}
 		std::cout << "[TextureManager] Loaded texture: " << assetName << std::endl;
 	}
 }
 
-void TextureManager::loadStreamingAssets(int maxTex)
+void TextureManager::loadStreamingAssets(int maxTex, CancellationToken token)
 {
-	int index = 0;
-	for (const auto& entry : std::filesystem::directory_iterator(STREAMING_PATH)) {
-		if (index < maxTex) {
-			IETThread::sleep(20);
+	int count = std::min(maxTex, this->streamingManifest.getCount());
+	for (int index = 0; index < count; index++) {
+		//no simulated delay here, throttled streaming is scheduled on timers (see LoadAssetThread)
+		if (token.IsCancelled()) return;
 
-			String path = entry.path().generic_string();
-			std::vector<String> tokens = StringUtils::split(path, '/');
-			String assetName = StringUtils::split(tokens[tokens.size() - 1], '.')[0];
-			this->instantiateAsTexture(path, assetName, true);
+		String path = this->streamingManifest.getEntry(index).path;
+		String assetName = getAssetName(path);
+		this->instantiateAsTexture(path, true);
 
-			std::cout << "[TextureManager] Loaded streaming texture: " << assetName << std::endl;
-			index++;
-		}
+		std::cout << "[TextureManager] Loaded streaming texture: " << assetName << std::endl;
 	}
 
 	//std::cout << "Num Textures: " << this->getNumLoadedStreamTextures() << std::endl;
@@ -60,46 +92,52 @@ void TextureManager::loadStreamingAssets(int maxTex)
 
 void TextureManager::loadSingleStreamAsset(int index)
 {
-	int fileNum = 0;
-	
-	for (const auto& entry : std::filesystem::directory_iterator(STREAMING_PATH)) {
-		if(index == fileNum)
-		{
-			//simulate loading of very large file
-			//<code here for thread sleeping. Fill this up only when instructor told so.>
-			IETThread::sleep(200);
-
-			String path = entry.path().generic_string();
-			std::vector<String> tokens = StringUtils::split(path, '/');
-			String assetName = StringUtils::split(tokens[tokens.size() - 1], '.')[0];
-			this->instantiateAsTexture(path, assetName, true);
-			
-			//<code here for loading asset>
-			//String assetName = "tile" + fileNum;
-	
-			std::cout << "[TextureManager] Loaded streaming texture: " << assetName << std::endl;
-			break;
-		}
+	if (index < 0 || index >= this->streamingManifest.getCount()) return;
 
-		fileNum++;
-	}
+	//simulate loading of very large file
+	//<code here for thread sleeping. Fill this up only when instructor told so.>
+	IETThread::sleep(200);
+
+	String path = this->streamingManifest.getEntry(index).path;
+	String assetName = getAssetName(path);
+	this->instantiateAsTexture(path, true);
+
+	std::cout << "[TextureManager] Loaded streaming texture: " << assetName << std::endl;
+}
+
+void TextureManager::loadStreamingAsset(const String& path)
+{
+	String assetName = getAssetName(path);
+	this->instantiateAsTexture(path, true);
+	std::cout << "[TextureManager] Loaded streaming texture: " << assetName << std::endl;
 }
 
-sf::Texture* TextureManager::getFromTextureMap(const String assetName, int frameIndex)
+TextureHandle TextureManager::getFromTextureMap(const String assetName, int frameIndex)
 {
-	if (!this->textureMap[assetName].empty()) {
-		return this->textureMap[assetName][frameIndex];
+	TextureShard& shard = this->getShard(assetName);
+	std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+	auto found = shard.textureMap.find(assetName);
+	if (found != shard.textureMap.end() && !found->second.empty()) {
+		int slot = found->second[frameIndex];
+		lock.unlock();
+
+		return this->acquireSlot(slot);
 	}
 	else {
 		std::cout << "[TextureManager] No texture found for " << assetName << std::endl;
-		return NULL;
+		return TextureHandle();
 	}
 }
 
 int TextureManager::getNumFrames(const String assetName)
 {
-	if (!this->textureMap[assetName].empty()) {
-		return this->textureMap[assetName].size();
+	TextureShard& shard = this->getShard(assetName);
+	std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+	auto found = shard.textureMap.find(assetName);
+	if (found != shard.textureMap.end() && !found->second.empty()) {
+		return found->second.size();
 	}
 	else {
 		std::cout << "[TextureManager] No texture found for " << assetName << std::endl;
@@ -107,38 +145,253 @@ int TextureManager::getNumFrames(const String assetName)
 	}
 }
 
-sf::Texture* TextureManager::getStreamTextureFromList(const int index)
+TextureHandle TextureManager::getStreamTextureFromList(const int index)
 {
-	return this->streamTextureList[index];
+	if (index < 0 || index >= this->getNumLoadedStreamTextures()) return TextureHandle();
+	//the tile may have been unloaded and its slot handed to another texture since it was listed
+	SlotRef ref = this->streamTextureList.Get(index);
+	return this->acquireSlot(ref.slot, ref.generation);
 }
 
 int TextureManager::getNumLoadedStreamTextures() const
 {
-	return this->streamTextureList.size();
+	return static_cast<int>(this->streamTextureList.Size());
 }
 
 void TextureManager::countStreamingAssets()
 {
-	this->streamingAssetCount = 0;
-	for (const auto& entry : std::filesystem::directory_iterator(STREAMING_PATH)) {
-		this->streamingAssetCount++;
-	}
+	//the folder is only walked when the cached index is missing or out of date
+	this->streamingManifest.load(STREAMING_PATH, STREAMING_INDEX_PATH);
+	this->streamingAssetCount = this->streamingManifest.getCount();
 	std::cout << "[TextureManager] Number of streaming assets: " << this->streamingAssetCount << std::endl;
 }
  
-void TextureManager::instantiateAsTexture(String path, String assetName, bool isStreaming)
+std::vector<TextureManager::String> TextureManager::getStreamingAssetPaths(int maxTex)
+{
+	return this->streamingManifest.getPaths(maxTex);
+}
+
+bool TextureManager::readAssetBytes(const String& path, AssetBytes& bytes)
+{
+	if (!AssetPack::getInstance()->read(path, bytes)) {
+		std::cout << "[TextureManager] Failed to open " << path << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool TextureManager::decodeImage(const String& path, const AssetBytes& bytes, sf::Image& image, bool isStreaming)
+{
+	if (!DecodedImageCache::getInstance()->decode(path, bytes, image)) return false;
+	if (isStreaming) {
+		//tiles are drawn at cell size, anything larger would only waste atlas space
+		AssetPack::shrinkToFit(image, this->streamingTileSize);
+	}
+	return true;
+}
+
+void TextureManager::setStreamingTileSize(const sf::Vector2u& size)
+{
+	this->streamingTileSize = size;
+}
+
+sf::Texture* TextureManager::uploadTexture(const String& path, const sf::Image& image, bool isStreaming)
+{
+	if (isStreaming) {
+		//the page being filled has to be resident before more tiles are written into it
+		int pageCount = this->streamingAtlas.getNumPages();
+		if (pageCount > 0) {
+			this->textureCache.acquire(this->streamingAtlas.getPage(pageCount - 1));
+		}
+
+		TextureRegion region;
+		if (this->streamingAtlas.pack(image, region)) {
+			if (this->streamingAtlas.getNumPages() != pageCount) {
+				this->textureCache.insert(region.texture, [this](sf::Texture& page) { return this->reloadAtlasPage(page); });
+			}
+			this->atlasSlots[region.texture].push_back({ path, region.rect });
+			this->streamTextureList.PushBack(this->getSlotRef(this->createSlot(region)));
+			return region.texture;
+		}
+		//too big for an atlas page, falls through to a texture of its own
+	}
+
+	sf::Texture* texture = new sf::Texture();
+	texture->loadFromImage(image);
+	this->registerTexture(texture, path, isStreaming);
+	return texture;
+}
+
+TextureManager::String TextureManager::getAssetName(const String& path)
 {
+	std::vector<String> tokens = StringUtils::split(path, '/');
+	return StringUtils::split(tokens[tokens.size() - 1], '.')[0];
+}
+
+void TextureManager::instantiateAsTexture(String path, bool isStreaming)
+{
+	if (isStreaming) {
+		//streaming loads run on pool workers, so only decode here and let the main thread create the texture
+		AssetBytes bytes;
+		auto image = std::make_shared<sf::Image>();
+		if (this->readAssetBytes(path, bytes) && this->decodeImage(path, bytes, *image, true)) {
+			TextureUploader::getInstance()->enqueue(path, image, true);
+		}
+		return;
+	}
+
 	sf::Texture* texture = new sf::Texture();
-	texture->loadFromFile(path);
-	this->textureMap[assetName].push_back(texture);
+	AssetPack::getInstance()->loadTexture(*texture, path);
+	this->registerTexture(texture, path, isStreaming);
+}
+
+void TextureManager::registerTexture(sf::Texture* texture, String path, bool isStreaming)
+{
+	TextureRegion region;
+	region.texture = texture;
+	region.rect = sf::IntRect(0, 0, texture->getSize().x, texture->getSize().y);
+	int slot = this->createSlot(region);
+
+	String assetName = getAssetName(path);
+	{
+		TextureShard& shard = this->getShard(assetName);
+		std::unique_lock<std::shared_mutex> lock(shard.mutex);
+		shard.textureMap[assetName].push_back(slot);
+	}
 
 	if(isStreaming)
 	{
-		this->streamTextureList.push_back(texture);
+		this->streamTextureList.PushBack(this->getSlotRef(slot));
 	}
 	else
 	{
-		this->baseTextureList.push_back(texture);
+		this->baseTextureList.PushBack(this->getSlotRef(slot));
+	}
+
+	this->textureCache.insert(texture, [path](sf::Texture& evicted) { return AssetPack::getInstance()->loadTexture(evicted, path); });
+}
+
+bool TextureManager::reloadAtlasPage(sf::Texture& page)
+{
+	sf::Image blank;
+	blank.create(this->streamingAtlas.getPageSize(), this->streamingAtlas.getPageSize(), sf::Color::Transparent);
+	if (!page.loadFromImage(blank)) return false;
+
+	for (const AtlasSlot& slot : this->atlasSlots[&page]) {
+		AssetBytes bytes;
+		sf::Image image;
+		if (this->readAssetBytes(slot.path, bytes) && this->decodeImage(slot.path, bytes, image, true)) {
+			page.update(image, slot.rect.left, slot.rect.top);
+		}
+	}
+	return true;
+}
+
+void TextureManager::unloadTexture(const String assetName)
+{
+	SlotList slots;
+	{
+		TextureShard& shard = this->getShard(assetName);
+		std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+		auto found = shard.textureMap.find(assetName);
+		if (found == shard.textureMap.end()) return;
+		slots.swap(found->second);
+		shard.textureMap.erase(found);
+	}
+
+	for (int slot : slots) {
+		TextureSlot* entry = this->textureSlots.Get(slot);
+
+		//outstanding handles carry the old generation, they now resolve to nothing and release into the void
+		entry->generation++;
+		entry->refCount = 0;
+
+		this->textureCache.erase(entry->region.texture);
+		delete entry->region.texture;
+		entry->region = TextureRegion();
+		this->freeSlots.push_back(slot);
+	}
+}
+
+void TextureManager::setTextureBudget(size_t bytes)
+{
+	this->textureCache.setBudget(bytes);
+}
+
+TextureCache::Stats TextureManager::getCacheStats() const
+{
+	return this->textureCache.getStats();
+}
+
+int TextureManager::createSlot(const TextureRegion& region)
+{
+	if (!this->freeSlots.empty()) {
+		int slot = this->freeSlots.back();
+		this->freeSlots.pop_back();
+		this->textureSlots.Get(slot)->region = region;
+		return slot;
 	}
-	
+
+	TextureSlot* entry = new TextureSlot();
+	entry->region = region;
+	return static_cast<int>(this->textureSlots.PushBack(entry));
+}
+
+TextureManager::SlotRef TextureManager::getSlotRef(int slot)
+{
+	SlotRef ref;
+	ref.slot = slot;
+	ref.generation = this->textureSlots.Get(slot)->generation;
+	return ref;
+}
+
+TextureHandle TextureManager::acquireSlot(int slot)
+{
+	return this->acquireSlot(slot, this->textureSlots.Get(slot)->generation);
+}
+
+TextureHandle TextureManager::acquireSlot(int slot, uint32_t generation)
+{
+	TextureSlot* entry = this->textureSlots.Get(slot);
+	if (entry->generation != generation) return TextureHandle();
+
+	//counts as a cache hit, or brings the texture back if it was evicted
+	this->textureCache.acquire(entry->region.texture);
+	if (!this->retainSlot(slot, generation)) return TextureHandle();
+	return TextureHandle(slot, generation);
+}
+
+bool TextureManager::retainSlot(int slot, uint32_t generation)
+{
+	TextureSlot* entry = this->textureSlots.Get(slot);
+	if (entry->generation != generation) return false;
+
+	//the first handle keeps the texture resident until the last one is dropped
+	if (entry->refCount++ == 0) {
+		this->textureCache.pin(entry->region.texture);
+	}
+	return true;
+}
+
+void TextureManager::releaseSlot(int slot, uint32_t generation)
+{
+	TextureSlot* entry = this->textureSlots.Get(slot);
+	if (entry->generation != generation) return;
+
+	if (--entry->refCount == 0) {
+		this->textureCache.unpin(entry->region.texture);
+	}
+}
+
+const TextureRegion* TextureManager::resolveSlot(int slot, uint32_t generation)
+{
+	TextureSlot* entry = this->textureSlots.Get(slot);
+	if (entry->generation != generation) return NULL;
+	return &entry->region;
+}
+
+TextureManager::TextureShard& TextureManager::getShard(const String& assetName)
+{
+	return this->shards[std::hash<String>{}(assetName) % SHARD_COUNT];
 }
@@ -1,39 +1,119 @@
 #pragma once
+#include <atomic>
 #include <unordered_map>
+#include <shared_mutex>
 #include "SFML/Graphics.hpp"
+#include "CancellationToken.h"
+#include "AppendOnlyList.h"
+#include "TextureAtlas.h"
+#include "TextureCache.h"
+#include "TextureHandle.h"
+#include "StreamingManifest.h"
+#include "AssetPack.h"
 
+/// <summary>
+/// Registry of every loaded texture. Loader threads register textures concurrently while the frame loop reads
+/// them: named lookups go through a sharded map where each shard has its own reader/writer lock, and the
+/// streaming and base lists are append-only, so index lookups never lock and never see a reallocation.
+/// Streaming tiles are packed into a TextureAtlas on upload and are looked up by index, not by name.
+/// Lookups hand out TextureHandles to registry slots rather than raw pointers. Every texture (an atlas page
+/// counts as one) is tracked by a byte-budgeted TextureCache; a texture with live handles stays resident, the
+/// rest may be evicted and are reloaded by the next lookup. Lookups and handles belong on the main thread.
+/// </summary>
 class TextureManager
 {
 public:
 	typedef std::string String;
-	typedef std::vector<sf::Texture*> TextureList;
-	typedef std::unordered_map<String, TextureList> HashTable;
+	typedef std::vector<int> SlotList; //registry slots, one per frame
+	typedef std::unordered_map<String, SlotList> HashTable;
 	
 public:
 	static TextureManager* getInstance();
 	void loadFromAssetList(); //loading of all assets needed for startup
-	void loadStreamingAssets(int maxTex);
-	void loadSingleStreamAsset(int index); //loads a single streaming asset based on index in directory
-	sf::Texture* getFromTextureMap(const String assetName, int frameIndex);
+	void loadStreamingAssets(int maxTex, CancellationToken token = CancellationToken()); //stops early once the token is cancelled
+	void loadSingleStreamAsset(int index); //loads a single streaming asset based on index in the streaming manifest
+	void loadStreamingAsset(const String& path);
+	TextureHandle getFromTextureMap(const String assetName, int frameIndex);
 	int getNumFrames(const String assetName);
 
-	sf::Texture* getStreamTextureFromList(const int index);
+	TextureHandle getStreamTextureFromList(const int index); //streaming tiles are atlased, draw with the handle's rect
 	int getNumLoadedStreamTextures() const;
 
+	//stages of the streaming pipeline (see TaskGraph). reading and decoding are safe on any thread,
+	//uploading creates the GL texture and must run on the main thread, normally through TextureUploader.
+	std::vector<String> getStreamingAssetPaths(int maxTex);
+	bool readAssetBytes(const String& path, AssetBytes& bytes); //no copy when the asset is in the AssetPack
+	bool decodeImage(const String& path, const AssetBytes& bytes, sf::Image& image, bool isStreaming = false); //see DecodedImageCache
+	sf::Texture* uploadTexture(const String& path, const sf::Image& image, bool isStreaming);
+	static String getAssetName(const String& path);
+
+	void setStreamingTileSize(const sf::Vector2u& size); //streaming tiles larger than this are shrunk on decode, 0 keeps full size
+	void unloadTexture(const String assetName); //frees every frame now, handles still held become expired
+	void setTextureBudget(size_t bytes);
+	TextureCache::Stats getCacheStats() const;
+
 private:
+	friend class TextureHandle;
+
 	TextureManager();
 	TextureManager(TextureManager const&) {};             // copy constructor is private
 	TextureManager& operator=(TextureManager const&) {};  // assignment operator is private
 	static TextureManager* sharedInstance;
 
-	HashTable textureMap;
-	TextureList baseTextureList;
-	TextureList streamTextureList;
+	struct TextureShard {
+		std::shared_mutex mutex;
+		HashTable textureMap;
+	};
+
+	static const int SHARD_COUNT = 16;
+	TextureShard shards[SHARD_COUNT];
+	//a slot outlives the texture in it; unloading bumps the generation and puts the slot up for reuse
+	struct TextureSlot {
+		TextureRegion region;
+		std::atomic<uint32_t> generation = 0;
+		std::atomic<int> refCount = 0;
+	};
+
+	//slot plus the generation it had when listed, a recycled slot no longer matches
+	struct SlotRef {
+		int slot = -1;
+		uint32_t generation = 0;
+	};
+
+	AppendOnlyList<TextureSlot*> textureSlots;
+	std::vector<int> freeSlots;
+	AppendOnlyList<SlotRef> baseTextureList;
+	AppendOnlyList<SlotRef> streamTextureList;
+	TextureAtlas streamingAtlas;
+
+	//what went into each atlas page, so an evicted page can be rebuilt
+	struct AtlasSlot {
+		String path;
+		sf::IntRect rect;
+	};
+	std::unordered_map<sf::Texture*, std::vector<AtlasSlot>> atlasSlots;
+
+	static const size_t DEFAULT_TEXTURE_BUDGET = 256 * 1024 * 1024;
+	TextureCache textureCache = TextureCache(DEFAULT_TEXTURE_BUDGET);
 
 	const std::string STREAMING_PATH = "Media/Streaming/";
+	const std::string STREAMING_INDEX_PATH = "Media/Streaming.index";
 	int streamingAssetCount = 0;
+	StreamingManifest streamingManifest;
+	sf::Vector2u streamingTileSize; //set before streaming starts, read by the decoding workers
 
 	void countStreamingAssets();
-	void instantiateAsTexture(String path, String assetName, bool isStreaming);
+	void instantiateAsTexture(String path, bool isStreaming);
+	void registerTexture(sf::Texture* texture, String path, bool isStreaming);
+	bool reloadAtlasPage(sf::Texture& page);
+	TextureShard& getShard(const String& assetName);
+
+	int createSlot(const TextureRegion& region);
+	SlotRef getSlotRef(int slot);
+	TextureHandle acquireSlot(int slot);
+	TextureHandle acquireSlot(int slot, uint32_t generation); //empty handle if the slot was unloaded since
+	bool retainSlot(int slot, uint32_t generation);
+	void releaseSlot(int slot, uint32_t generation);
+	const TextureRegion* resolveSlot(int slot, uint32_t generation);
 
 };
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include "TextureUploader.h"
+#include "TextureManager.h"
+
+//a singleton class. created eagerly since loader threads are usually the first to enqueue.
+TextureUploader* TextureUploader::sharedInstance = new TextureUploader();
+
+TextureUploader* TextureUploader::getInstance() {
+	return sharedInstance;
+}
+
+void TextureUploader::enqueue(const String& path, std::shared_ptr<sf::Image> image, bool isStreaming, UploadCallback onUploaded)
+{
+	PendingUpload upload;
+	upload.path = path;
+	upload.image = std::move(image);
+	upload.isStreaming = isStreaming;
+	upload.onUploaded = std::move(onUploaded);
+
+	std::lock_guard<std::mutex> lock(this->queueMutex);
+	this->pendingUploads.push_back(std::move(upload));
+}
+
+void TextureUploader::runAfterPending(std::function<void()> callback)
+{
+	PendingUpload upload;
+	upload.barrier = std::move(callback);
+
+	std::lock_guard<std::mutex> lock(this->queueMutex);
+	this->pendingUploads.push_back(std::move(upload));
+}
+
+void TextureUploader::processUploads()
+{
+	sf::Clock clock;
+	size_t uploadedBytes = 0;
+
+	PendingUpload upload;
+	while (this->popPending(upload)) {
+		if (upload.barrier) {
+			upload.barrier();
+			continue;
+		}
+
+		sf::Vector2u size = upload.image->getSize();
+		sf::Texture* texture = TextureManager::getInstance()->uploadTexture(upload.path, *upload.image, upload.isStreaming);
+		upload.image = nullptr;
+		if (upload.onUploaded) upload.onUploaded(texture);
+
+		uploadedBytes += static_cast<size_t>(size.x) * size.y * 4;
+		if (uploadedBytes >= this->frameBudgetBytes || clock.getElapsedTime().asSeconds() * 1000.0f >= this->frameBudgetMs) {
+			break;
+		}
+	}
+}
+
+void TextureUploader::setFrameBudget(float maxMilliseconds, size_t maxBytes)
+{
+	this->frameBudgetMs = maxMilliseconds;
+	this->frameBudgetBytes = maxBytes;
+}
+
+int TextureUploader::getNumPending()
+{
+	std::lock_guard<std::mutex> lock(this->queueMutex);
+	return static_cast<int>(this->pendingUploads.size());
+}
+
+bool TextureUploader::popPending(PendingUpload& upload)
+{
+	std::lock_guard<std::mutex> lock(this->queueMutex);
+	if (this->pendingUploads.empty()) return false;
+
+	upload = std::move(this->pendingUploads.front());
+	this->pendingUploads.pop_front();
+	return true;
+}
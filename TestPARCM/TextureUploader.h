@@ -0,0 +1,48 @@
+#pragma once
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "SFML/Graphics.hpp"
+
+/// <summary>
+/// Turns decoded images into textures on the main thread. Loader threads only decode into sf::Image and
+/// enqueue the pixels here; the frame loop calls processUploads once per frame, which creates textures until
+/// the frame's time or byte budget is used up and leaves the rest for the next frame. At least one upload
+/// happens per frame so a single oversized image cannot stall the queue.
+/// </summary>
+class TextureUploader
+{
+public:
+	typedef std::string String;
+	typedef std::function<void(sf::Texture*)> UploadCallback;
+
+	static TextureUploader* getInstance();
+	void enqueue(const String& path, std::shared_ptr<sf::Image> image, bool isStreaming, UploadCallback onUploaded = nullptr);
+	void runAfterPending(std::function<void()> callback); //runs on the main thread once everything enqueued before it is uploaded
+	void processUploads();
+	void setFrameBudget(float maxMilliseconds, size_t maxBytes);
+	int getNumPending();
+
+private:
+	TextureUploader() {};
+	TextureUploader(TextureUploader const&) {};             // copy constructor is private
+	TextureUploader& operator=(TextureUploader const&) { return *this; };  // assignment operator is private
+	static TextureUploader* sharedInstance;
+
+	struct PendingUpload {
+		String path;
+		std::shared_ptr<sf::Image> image;
+		bool isStreaming = true;
+		UploadCallback onUploaded;
+		std::function<void()> barrier; //set instead of image for runAfterPending
+	};
+
+	bool popPending(PendingUpload& upload);
+
+	std::mutex queueMutex;
+	std::deque<PendingUpload> pendingUploads;
+
+	float frameBudgetMs = 4.0f;
+	size_t frameBudgetBytes = 8 * 1024 * 1024;
+};
@@ -1,58 +1,378 @@
 #include "ThreadPool.h"
+#include "TaskGroup.h"
+
+#include <algorithm>
+
+namespace {
+	//identifies the pool worker running on the current thread, if any
+	thread_local ThreadPool* currentPool = nullptr;
+	thread_local int currentWorkerID = -1;
+}
 
 ThreadPool::ThreadPool(int _workerCount) {
 	workerCount = _workerCount;
+	for (int p = 0; p < PRIORITY_COUNT; p++) {
+		this->InjectionQueues.push_back(new MPMCQueue<QueuedTask>(INJECTION_CAPACITY));
+	}
 	for (int i = 0; i < workerCount; i++) {
-		this->InactiveThreads.push(new WorkerThread(i, this));
+		this->Workers.push_back(new WorkerThread(i, this, this));
+		this->RunningTasks.push_back(nullptr);
+		for (int p = 0; p < PRIORITY_COUNT; p++) {
+			this->LocalQueues.push_back(new WorkStealingQueue());
+		}
 	}
 }
 
 ThreadPool::~ThreadPool() {
+	this->StopScheduling();
+
+	//workers hold a pointer back to the pool, so wait for every one of them to leave run() first
+	unique_lock<mutex> lock(this->sleepMutex);
+	this->workersExited.wait(lock, [this] { return this->liveWorkers == 0; });
+	lock.unlock();
 
+	for (auto worker : this->Workers) {
+		delete worker;
+	}
+	for (auto queue : this->LocalQueues) {
+		delete queue;
+	}
+	for (auto queue : this->InjectionQueues) {
+		delete queue;
+	}
 }
 
 void ThreadPool::StartScheduling() {
+	unique_lock<mutex> lock(this->sleepMutex);
+	if (this->isRunning) return;
+
+	//a previous StopScheduling may still have workers draining out
+	this->workersExited.wait(lock, [this] { return this->liveWorkers == 0; });
+
 	this->isRunning = true;
-	this->start();
+	this->liveWorkers = workerCount;
+	lock.unlock();
+
+	for (auto worker : this->Workers) {
+		worker->start();
+	}
 }
 
 void ThreadPool::StopScheduling() {
-	this->isRunning = false;
+	{
+		lock_guard<mutex> lock(this->sleepMutex);
+		this->isRunning = false;
+	}
+	this->taskAvailable.notify_all();
 }
 
 void ThreadPool::WaitAll() {
-	while (!PendingTasks.empty() || !ActiveThreads.empty())
-		IETThread::sleep(10);
+	while (this->outstandingTasks > 0) {
+		//help out while there is queued work, block once everything left is already running
+		if (this->TryRunPendingTask()) continue;
+
+		unique_lock<mutex> lock(this->waitMutex);
+		this->allTasksDone.wait(lock, [this] { return this->outstandingTasks == 0; });
+	}
 }
 
-void ThreadPool::ScheduleTask(IWorkerAction* _task) {
-	this->PendingTasks.push(_task);
+bool ThreadPool::TryRunPendingTask() {
+	shared_ptr<TaskState> task = this->TryAcquireTask(this->GetLocalWorkerID());
+	if (task == nullptr) return false;
+
+	task->OnStartTask();
+	this->FinishTask();
+	return true;
 }
 
-void ThreadPool::run() {
-	while (this->isRunning) {
-		if (!this->PendingTasks.empty()) {
-			if (!this->InactiveThreads.empty()) {
-				auto workerThread = this->InactiveThreads.front();
-				this->InactiveThreads.pop();
+void ThreadPool::FinishTask() {
+	if (--this->outstandingTasks == 0) {
+		lock_guard<mutex> lock(this->waitMutex);
+		this->allTasksDone.notify_all();
+	}
+}
+
+TaskHandle ThreadPool::ScheduleTask(IWorkerAction* _task, TaskPriority _priority) {
+	auto state = make_shared<TaskState>();
+	state->action = _task;
+	state->owner = this;
+	state->priority = _priority;
+
+	this->Submit(state);
+	return TaskHandle(state);
+}
+
+TaskHandle ThreadPool::ScheduleTask(function<void()> _task, TaskPriority _priority) {
+	auto state = make_shared<TaskState>();
+	state->function = std::move(_task);
+	state->owner = this;
+	state->priority = _priority;
+
+	this->Submit(state);
+	return TaskHandle(state);
+}
+
+void ThreadPool::Submit(shared_ptr<TaskState> _state) {
+	this->outstandingTasks++;
+	_state->queued = true;
+	this->Enqueue({ _state, _state->priority });
+}
+
+vector<TaskHandle> ThreadPool::ScheduleTasks(span<IWorkerAction* const> _tasks, TaskPriority _priority) {
+	vector<shared_ptr<TaskState>> states;
+	vector<TaskHandle> handles;
+	states.reserve(_tasks.size());
+	handles.reserve(_tasks.size());
+
+	for (IWorkerAction* task : _tasks) {
+		auto state = make_shared<TaskState>();
+		state->action = task;
+		state->owner = this;
+		state->priority = _priority;
+		states.push_back(state);
+		handles.push_back(TaskHandle(state));
+	}
+
+	this->SubmitBatch(states, _priority);
+	return handles;
+}
+
+vector<TaskHandle> ThreadPool::ScheduleTasks(vector<function<void()>> _tasks, TaskPriority _priority) {
+	vector<shared_ptr<TaskState>> states;
+	vector<TaskHandle> handles;
+	states.reserve(_tasks.size());
+	handles.reserve(_tasks.size());
+
+	for (auto& task : _tasks) {
+		auto state = make_shared<TaskState>();
+		state->function = std::move(task);
+		state->owner = this;
+		state->priority = _priority;
+		states.push_back(state);
+		handles.push_back(TaskHandle(state));
+	}
+
+	this->SubmitBatch(states, _priority);
+	return handles;
+}
+
+void ThreadPool::ParallelFor(int _begin, int _end, int _grain, function<void(int, int)> _body, TaskPriority _priority) {
+	if (_end <= _begin) return;
+
+	if (_grain <= 0) {
+		//a few chunks per worker so a slow chunk does not leave everybody else idle at the end
+		_grain = max(1, (_end - _begin) / (workerCount * 4));
+	}
+
+	vector<function<void()>> chunks;
+	for (int start = _begin; start < _end; start += _grain) {
+		int stop = min(_end, start + _grain);
+		chunks.push_back([_body, start, stop]() { _body(start, stop); });
+	}
+
+	TaskGroup group(this);
+	group.RunBatch(std::move(chunks), _priority);
+	group.Wait();
+}
+
+void ThreadPool::SubmitBatch(const vector<shared_ptr<TaskState>>& _states, TaskPriority _priority) {
+	if (_states.empty()) return;
+
+	vector<QueuedTask> entries;
+	entries.reserve(_states.size());
+	for (const auto& state : _states) {
+		state->queued = true;
+		entries.push_back({ state, _priority });
+	}
+
+	//workers push into their own queue, everyone else picks one round-robin. the ring is skipped on purpose,
+	//it would cost one CAS per task and could fill up halfway through the batch
+	int localID = this->GetLocalWorkerID();
+	int target = localID != -1 ? localID : this->nextQueue++ % workerCount;
+
+	int count = static_cast<int>(entries.size());
+	this->outstandingTasks += count;
+	this->GetQueue(target, _priority)->PushBackRange(entries);
+	this->queuedTasks += count;
+
+	this->WakeWorkers(count);
+}
+
+void ThreadPool::Reprioritize(shared_ptr<TaskState> _state, TaskPriority _priority) {
+	int previous = _state->priority.exchange(_priority);
+	if (previous == _priority) return;
+
+	//a task that is not queued yet picks the new priority up when it gets submitted. Submit sets queued
+	//before it reads the priority, so one of the two always sees the other's write
+	if (!_state->queued || _state->claimed) return;
+
+	//the entry under the old priority becomes stale and is skipped when a worker pops it
+	this->Enqueue({ _state, _priority });
+}
+
+TaskHandle ThreadPool::ScheduleDelayed(IWorkerAction* _task, int _delayMs, TaskPriority _priority) {
+	auto state = make_shared<TaskState>();
+	state->action = _task;
+	state->owner = this;
+	state->priority = _priority;
+
+	//not queued until the timer fires, a SetPriority before that only changes what Submit reads here
+	this->AddTimer([this, state]() { this->Submit(state); }, _delayMs, 0);
+	return TaskHandle(state);
+}
+
+TaskHandle ThreadPool::ScheduleDelayed(function<void()> _task, int _delayMs, TaskPriority _priority) {
+	auto state = make_shared<TaskState>();
+	state->function = std::move(_task);
+	state->owner = this;
+	state->priority = _priority;
+
+	this->AddTimer([this, state]() { this->Submit(state); }, _delayMs, 0);
+	return TaskHandle(state);
+}
+
+TimerQueue::TimerID ThreadPool::SchedulePeriodic(function<void()> _task, int _periodMs, TaskPriority _priority) {
+	return this->AddTimer([this, _task, _priority]() { this->ScheduleTask(_task, _priority); }, _periodMs, _periodMs);
+}
+
+void ThreadPool::CancelTimer(TimerQueue::TimerID _id) {
+	this->Timers.Cancel(_id);
+}
+
+TimerQueue::TimerID ThreadPool::AddTimer(function<void()> _callback, int _delayMs, int _periodMs) {
+	TimerQueue::TimerID id = this->Timers.Add(std::move(_callback), _delayMs, _periodMs);
+
+	{
+		lock_guard<mutex> lock(this->sleepMutex);
+		this->timerGeneration++;
+	}
+	this->taskAvailable.notify_one();
+	return id;
+}
+
+void ThreadPool::PumpTimers() {
+	vector<TimerQueue::Callback> due;
+	if (this->Timers.CollectDue(due)) {
+		for (auto& callback : due) {
+			callback();
+		}
+	}
+}
+
+void ThreadPool::Enqueue(const QueuedTask& _task) {
+	int localID = this->GetLocalWorkerID();
+
+	if (localID != -1) {
+		this->GetQueue(localID, _task.priority)->PushBack(_task);
+	}
+	else if (!this->InjectionQueues[_task.priority]->TryEnqueue(_task)) {
+		//injection ring is full, spill into a worker queue rather than block the caller
+		this->GetQueue(this->nextQueue++ % workerCount, _task.priority)->PushBack(_task);
+	}
+	this->queuedTasks++;
+
+	this->WakeWorkers(1);
+}
 
-				this->ActiveThreads[workerThread->GetID()] = workerThread;
+void ThreadPool::WakeWorkers(int _count) {
+	//only pay for the lock when somebody is actually parked
+	if (this->sleepingWorkers == 0) return;
 
-				auto task = this->PendingTasks.front();
-				this->PendingTasks.pop();
-				workerThread->AssignTask(task);
+	{ lock_guard<mutex> lock(this->sleepMutex); }
+	if (_count == 1) {
+		this->taskAvailable.notify_one();
+	}
+	else {
+		this->taskAvailable.notify_all();
+	}
+}
 
-				workerThread->start();
+int ThreadPool::GetLocalWorkerID() {
+	return currentPool == this ? currentWorkerID : -1;
+}
+
+WorkStealingQueue* ThreadPool::GetQueue(int worker, int priority) {
+	return this->LocalQueues[worker * PRIORITY_COUNT + priority];
+}
+
+bool ThreadPool::TryClaim(const QueuedTask& _task) {
+	if (_task.state->priority != _task.priority) return false;
+
+	bool expected = false;
+	return _task.state->claimed.compare_exchange_strong(expected, true);
+}
+
+shared_ptr<TaskState> ThreadPool::TryAcquireTask(int id) {
+	QueuedTask entry;
+
+	//id is -1 for threads outside the pool, they have no queue of their own and steal from everybody
+	for (int p = 0; p < PRIORITY_COUNT; p++) {
+		bool found = id != -1 && this->GetQueue(id, p)->PopFront(entry);
+		if (!found) {
+			found = this->InjectionQueues[p]->TryDequeue(entry);
+		}
+		for (int i = 0; !found && i < workerCount; i++) {
+			int victim = (id + 1 + i) % workerCount;
+			if (victim == id) continue;
+			found = this->GetQueue(victim, p)->Steal(entry);
+		}
+
+		if (found) {
+			this->queuedTasks--;
+			if (this->TryClaim(entry)) {
+				return entry.state;
 			}
+			//stale entry left behind by a priority change, look again from the top
+			p = -1;
 		}
 	}
+
+	return nullptr;
+}
+
+IWorkerAction* ThreadPool::WaitForTask(int id) {
+	currentPool = this;
+	currentWorkerID = id;
+
+	while (this->isRunning) {
+		this->PumpTimers();
+
+		shared_ptr<TaskState> task = this->TryAcquireTask(id);
+		if (task != nullptr) {
+			this->RunningTasks[id] = task;
+			return task.get();
+		}
+
+		unique_lock<mutex> lock(this->sleepMutex);
+		this->sleepingWorkers++;
+
+		int seenGeneration = this->timerGeneration;
+		auto ready = [this, seenGeneration] {
+			return !this->isRunning || this->queuedTasks > 0 || this->timerGeneration != seenGeneration;
+		};
+
+		TimerQueue::Clock::time_point deadline;
+		if (this->Timers.GetNextDeadline(deadline)) {
+			this->taskAvailable.wait_until(lock, deadline, ready);
+		}
+		else {
+			this->taskAvailable.wait(lock, ready);
+		}
+		this->sleepingWorkers--;
+	}
+
+	return nullptr;
 }
 
 void ThreadPool::OnFinishedTask(int id) {
-	if (this->ActiveThreads[id] != nullptr) {
-		delete this->ActiveThreads[id];
-		this->ActiveThreads.erase(id);
+	this->RunningTasks[id] = nullptr;
+	this->FinishTask();
+}
 
-		InactiveThreads.push(new WorkerThread(id, this));
+void ThreadPool::OnWorkerExited(int) {
+	lock_guard<mutex> lock(this->sleepMutex);
+	this->liveWorkers--;
+	if (this->liveWorkers == 0) {
+		this->workersExited.notify_all();
 	}
-}
\ No newline at end of file
+}
@@ -3,32 +3,103 @@
 #include "IETThread.h"
 #include "WorkerThread.h"
 #include "IWorkerAction.h"
+#include "WorkStealingQueue.h"
+#include "TaskHandle.h"
+#include "TimerQueue.h"
+#include "MPMCQueue.h"
 
-#include <queue>
-#include <unordered_map>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <vector>
 
 using namespace std;
 
-class ThreadPool : public IETThread, public IFinishedTask {
+/// <summary>
+/// Fixed-size pool of persistent workers. Each worker owns a WorkStealingQueue; tasks scheduled from a worker
+/// go to that worker's queue, tasks scheduled from outside go into a lock-free injection ring (spilling
+/// round-robin into the worker queues if it is full), and idle workers steal from busy ones.
+/// Workers with nothing to run or steal park on a condition variable.
+/// Every worker keeps one queue per TaskPriority; a worker drains all higher priority work in the pool,
+/// stealing if needed, before it looks at a lower priority.
+/// Tasks complete on the worker that ran them; use TaskHandle::Then to get back onto the main thread.
+/// Delayed and periodic tasks wait in a TimerQueue instead of sleeping on a worker. Idle workers park until
+/// the earliest deadline and move expired timers into the queues. WaitAll does not wait for timers that
+/// have not fired yet, and must not be called from a pool worker since the caller's own task never finishes.
+/// Changing the priority of a delayed task before its timer fires only sets the priority it is submitted with.
+/// </summary>
+class ThreadPool : public ITaskSource, public IFinishedTask {
 public:
 	ThreadPool(int _workerCount);
 	~ThreadPool();
 
 	void StartScheduling();
 	void StopScheduling();
-	void WaitAll();
+	void WaitAll(); //blocks until every scheduled task finished, running queued tasks on the calling thread meanwhile
+	bool TryRunPendingTask(); //runs one queued task on the calling thread, returns false if there was nothing to run
 
-	void ScheduleTask(IWorkerAction* _task);
+	TaskHandle ScheduleTask(IWorkerAction* _task, TaskPriority _priority = PRIORITY_NORMAL);
+	TaskHandle ScheduleTask(function<void()> _task, TaskPriority _priority = PRIORITY_NORMAL);
+	//bulk submission, the whole batch lands in one worker queue under a single lock and idle workers steal
+	//from there. cheaper than calling ScheduleTask in a loop when submitting hundreds of small tasks.
+	vector<TaskHandle> ScheduleTasks(span<IWorkerAction* const> _tasks, TaskPriority _priority = PRIORITY_NORMAL);
+	vector<TaskHandle> ScheduleTasks(vector<function<void()>> _tasks, TaskPriority _priority = PRIORITY_NORMAL);
 
-	bool isRunning = false;
+	//splits [_begin, _end) into chunks of _grain indices and calls _body(chunkBegin, chunkEnd) for each on the
+	//pool, returning once all chunks ran. the caller runs chunks too. _grain <= 0 picks a size from the worker count.
+	void ParallelFor(int _begin, int _end, int _grain, function<void(int, int)> _body, TaskPriority _priority = PRIORITY_NORMAL);
+
+	void Reprioritize(shared_ptr<TaskState> _state, TaskPriority _priority);
+
+	TaskHandle ScheduleDelayed(IWorkerAction* _task, int _delayMs, TaskPriority _priority = PRIORITY_NORMAL);
+	TaskHandle ScheduleDelayed(function<void()> _task, int _delayMs, TaskPriority _priority = PRIORITY_NORMAL);
+	TimerQueue::TimerID SchedulePeriodic(function<void()> _task, int _periodMs, TaskPriority _priority = PRIORITY_NORMAL);
+	void CancelTimer(TimerQueue::TimerID _id);
+
+	atomic<bool> isRunning = false;
 
 private:
-	void run() override;
+	friend struct TaskState;
+	void Submit(shared_ptr<TaskState> _state);
+	void SubmitBatch(const vector<shared_ptr<TaskState>>& _states, TaskPriority _priority);
+	void WakeWorkers(int _count);
+
+	IWorkerAction* WaitForTask(int id) override;
+	void OnWorkerExited(int id) override;
 	void OnFinishedTask(int id) override;
 
+	shared_ptr<TaskState> TryAcquireTask(int id);
+	void FinishTask();
+	bool TryClaim(const QueuedTask& _task);
+	void Enqueue(const QueuedTask& _task);
+	int GetLocalWorkerID();
+	void PumpTimers();
+	TimerQueue::TimerID AddTimer(function<void()> _callback, int _delayMs, int _periodMs);
+	WorkStealingQueue* GetQueue(int worker, int priority);
+
 	int workerCount = 1;
+	vector<WorkerThread*> Workers;
+	vector<WorkStealingQueue*> LocalQueues;
+	vector<MPMCQueue<QueuedTask>*> InjectionQueues; //one per priority, filled by non-worker threads
+	vector<shared_ptr<TaskState>> RunningTasks; //indexed by worker id, keeps the running task alive
+
+	static const int INJECTION_CAPACITY = 1024;
+
+	atomic<int> nextQueue = 0;
+	atomic<int> queuedTasks = 0;
+	atomic<int> outstandingTasks = 0;
+	atomic<int> sleepingWorkers = 0;
+
+	TimerQueue Timers;
+	int timerGeneration = 0; //bumped under sleepMutex whenever a timer is added, so sleepers recompute their deadline
+
+	mutex sleepMutex;
+	condition_variable taskAvailable;
+	condition_variable workersExited;
+	int liveWorkers = 0;
 
-	queue<IWorkerAction*> PendingTasks;
-	unordered_map<int, WorkerThread*> ActiveThreads;
-	queue<WorkerThread*> InactiveThreads;
-};
\ No newline at end of file
+	mutex waitMutex;
+	condition_variable allTasksDone; //signalled when outstandingTasks drops to zero
+};
@@ -0,0 +1,57 @@
+#include "TimerQueue.h"
+#include <algorithm>
+
+TimerQueue::TimerID TimerQueue::Add(Callback _callback, int _delayMs, int _periodMs) {
+	std::lock_guard<std::mutex> lock(this->timerMutex);
+
+	TimerID id = this->nextID++;
+	this->timers.push_back({ Clock::now() + std::chrono::milliseconds(_delayMs), id, _periodMs, std::move(_callback) });
+	std::push_heap(this->timers.begin(), this->timers.end(), std::greater<Timer>());
+	this->pendingTimers.insert(id);
+	return id;
+}
+
+void TimerQueue::Cancel(TimerID _id) {
+	std::lock_guard<std::mutex> lock(this->timerMutex);
+	this->pendingTimers.erase(_id);
+}
+
+bool TimerQueue::GetNextDeadline(Clock::time_point& _deadline) {
+	std::lock_guard<std::mutex> lock(this->timerMutex);
+	if (this->timers.empty()) return false;
+
+	_deadline = this->timers.front().deadline;
+	return true;
+}
+
+bool TimerQueue::CollectDue(std::vector<Callback>& _due) {
+	std::lock_guard<std::mutex> lock(this->timerMutex);
+	Clock::time_point now = Clock::now();
+	bool any = false;
+
+	while (!this->timers.empty() && this->timers.front().deadline <= now) {
+		std::pop_heap(this->timers.begin(), this->timers.end(), std::greater<Timer>());
+		Timer& timer = this->timers.back();
+
+		if (this->pendingTimers.count(timer.id) == 0) {
+			this->timers.pop_back(); //cancelled
+			continue;
+		}
+		any = true;
+
+		if (timer.periodMs > 0) {
+			_due.push_back(timer.callback);
+			//re-arm relative to the old deadline so periodic timers do not drift
+			timer.deadline += std::chrono::milliseconds(timer.periodMs);
+			if (timer.deadline <= now) timer.deadline = now + std::chrono::milliseconds(timer.periodMs);
+			std::push_heap(this->timers.begin(), this->timers.end(), std::greater<Timer>());
+		}
+		else {
+			_due.push_back(std::move(timer.callback));
+			this->pendingTimers.erase(timer.id);
+			this->timers.pop_back();
+		}
+	}
+
+	return any;
+}
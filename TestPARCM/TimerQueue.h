@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+/// <summary>
+/// Min-heap of delayed and periodic callbacks. It owns no thread: whoever drives it (idle pool workers,
+/// the main thread dispatcher) asks for the next deadline, sleeps until then and collects what is due.
+/// </summary>
+class TimerQueue {
+public:
+	typedef std::function<void()> Callback;
+	typedef std::chrono::steady_clock Clock;
+	typedef int TimerID;
+
+	TimerID Add(Callback _callback, int _delayMs, int _periodMs = 0); //_periodMs > 0 re-arms the timer after every run
+	void Cancel(TimerID _id); //no-op once a one-shot timer has fired
+
+	bool GetNextDeadline(Clock::time_point& _deadline);
+	bool CollectDue(std::vector<Callback>& _due); //appends every expired callback to _due (one-shot ones are moved, periodic ones copied), returns true if any
+
+private:
+	struct Timer {
+		Clock::time_point deadline;
+		TimerID id;
+		int periodMs;
+		Callback callback;
+
+		bool operator>(const Timer& other) const { return deadline > other.deadline; }
+	};
+
+	std::mutex timerMutex;
+	std::vector<Timer> timers; //min-heap on deadline, kept with std::push_heap / std::pop_heap
+	std::unordered_set<TimerID> pendingTimers; //ids that may still run, a cancelled timer is dropped when it comes due
+	TimerID nextID = 1;
+};
@@ -0,0 +1,29 @@
+#include "WorkStealingQueue.h"
+
+void WorkStealingQueue::PushBack(const QueuedTask& _task) {
+	std::lock_guard<std::mutex> lock(this->queueMutex);
+	this->tasks.push_back(_task);
+}
+
+void WorkStealingQueue::PushBackRange(const std::vector<QueuedTask>& _tasks) {
+	std::lock_guard<std::mutex> lock(this->queueMutex);
+	this->tasks.insert(this->tasks.end(), _tasks.begin(), _tasks.end());
+}
+
+bool WorkStealingQueue::PopFront(QueuedTask& _task) {
+	std::lock_guard<std::mutex> lock(this->queueMutex);
+	if (this->tasks.empty()) return false;
+
+	_task = std::move(this->tasks.front());
+	this->tasks.pop_front();
+	return true;
+}
+
+bool WorkStealingQueue::Steal(QueuedTask& _task) {
+	std::lock_guard<std::mutex> lock(this->queueMutex);
+	if (this->tasks.empty()) return false;
+
+	_task = std::move(this->tasks.back());
+	this->tasks.pop_back();
+	return true;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "TaskHandle.h"
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/// <summary>
+/// A task together with the priority it was queued under. If the task has since been moved to another
+/// priority the entry is stale and gets dropped when popped.
+/// </summary>
+struct QueuedTask {
+	std::shared_ptr<TaskState> state;
+	int priority = PRIORITY_NORMAL;
+};
+
+/// <summary>
+/// Per-worker task deque guarded by a single mutex, so the owner and thieves do contend for the same lock.
+/// The owning worker takes tasks from the front so work runs in submission order, while idle workers steal
+/// from the back, taking the work the owner would have reached last. Contention stays low because each
+/// worker mostly locks its own queue and only reaches into others when it runs dry.
+/// </summary>
+class WorkStealingQueue {
+public:
+	void PushBack(const QueuedTask& _task);
+	void PushBackRange(const std::vector<QueuedTask>& _tasks); //one lock for the whole batch
+	bool PopFront(QueuedTask& _task);
+	bool Steal(QueuedTask& _task);
+
+private:
+	std::mutex queueMutex;
+	std::deque<QueuedTask> tasks;
+};
@@ -1,7 +1,8 @@
 #include "WorkerThread.h"
 
-WorkerThread::WorkerThread(int _id, IFinishedTask* _onDone) {
+WorkerThread::WorkerThread(int _id, ITaskSource* _source, IFinishedTask* _onDone) {
 	id = _id;
+	source = _source;
 	onDone = _onDone;
 }
 
@@ -9,16 +10,20 @@ WorkerThread::~WorkerThread() {
 
 }
 
-void WorkerThread::AssignTask(IWorkerAction* _task) {
-	this->task = _task;
-}
-
 void WorkerThread::run() {
-	if (task != nullptr) {
+	//stays alive for the lifetime of the pool, parking inside WaitForTask while there is no work
+	while (true) {
+		IWorkerAction* task = source->WaitForTask(id);
+		if (task == nullptr) {
+			break;
+		}
+
 		task->OnStartTask();
-	}
 
-	if (onDone != nullptr) {
-		onDone->OnFinishedTask(id);
+		if (onDone != nullptr) {
+			onDone->OnFinishedTask(id);
+		}
 	}
-}
\ No newline at end of file
+
+	source->OnWorkerExited(id);
+}
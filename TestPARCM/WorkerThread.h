@@ -9,19 +9,28 @@ public:
 	virtual void OnFinishedTask(int id) = 0;
 };
 
+/// <summary>
+/// Supplies work to a persistent worker. WaitForTask parks the calling worker until a task is available
+/// and returns nullptr once the worker should exit.
+/// </summary>
+class ITaskSource {
+public:
+	virtual IWorkerAction* WaitForTask(int id) = 0;
+	virtual void OnWorkerExited(int id) = 0;
+};
+
 class WorkerThread : public IETThread {
 public:
-	WorkerThread(int _id, IFinishedTask* _onDone);
+	WorkerThread(int _id, ITaskSource* _source, IFinishedTask* _onDone);
 	~WorkerThread();
 
-	void AssignTask(IWorkerAction* _task);
 	int GetID() { return id; }
 
 protected:
 	void run() override;
 
 	int id;
+	ITaskSource* source;
 	IFinishedTask* onDone;
-	IWorkerAction* task;
 };
 
@@ -3,8 +3,27 @@
 #include "PlayButtonScene.h"
 #include "LoadingScene.h"
 #include "MusicPlayerScene.h"
+#include "MainThreadDispatcher.h"
+#include "AssetPack.h"
+#include "TextureUploader.h"
+#include "ImageBenchmark.h"
+#include "TaskSelfTest.h"
+#include <cstring>
+
+int main(int argc, char** argv) {
+    //kernel timings only, no window
+    if (argc > 1 && std::strcmp(argv[1], "--bench-image") == 0) {
+        ImageBenchmark::run();
+        return 0;
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--test-tasks") == 0) {
+        return TaskSelfTest::run() ? 0 : 1;
+    }
+
+    //one mapped archive instead of hundreds of loose files, built on the first run
+    bool rebuildPack = argc > 1 && std::strcmp(argv[1], "--rebuild-pack") == 0;
+    AssetPack::getInstance()->openOrBuild("Media/assets.pak", "Media", rebuildPack);
 
-int main() {
     sf::RenderWindow window(sf::VideoMode(1280, 720), "Music Player");
     window.setFramerateLimit(120); 
     PlayButtonScene playScene(&window);
@@ -16,6 +35,8 @@ int main() {
         while (window.pollEvent(event)) {
             if (loadingScene.isActive()) {
                 loadingScene.handleEvent(event);
+                // album switching stays live during a load, a newer request cancels the one in flight
+                if (musicPlayerScene.isActive()) musicPlayerScene.handleEvent(event);
             }
             else if (musicPlayerScene.isActive()) {
                 musicPlayerScene.handleEvent(event);
@@ -27,16 +48,19 @@ int main() {
             if (event.type == sf::Event::Closed) window.close();
         }
 
+        MainThreadDispatcher::getInstance()->drainQueue();
+        TextureUploader::getInstance()->processUploads();
+
         if (!loadingScene.isActive() && playScene.isLoadingRequested()) {
             playScene.clearLoadingRequest();
             loadingScene.start();
             musicPlayerScene.beginBackgroundLoad(musicPlayerScene.getCurrentAlbumIndex());
         }
 
-        if (!loadingScene.isActive() && musicPlayerScene.hasPendingAlbumRequest()) {
+        if (musicPlayerScene.hasPendingAlbumRequest()) {
             int idx = musicPlayerScene.consumePendingAlbumRequest();
             if (idx >= 0) {
-                loadingScene.start();
+                if (!loadingScene.isActive()) loadingScene.start();
                 musicPlayerScene.beginBackgroundLoad(idx);
             }
         }